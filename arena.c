@@ -0,0 +1,100 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdalign.h>
+#include <stddef.h>
+#include "arena.h"
+#include "utilities.h"
+
+// Size of the blocks that the arena gets from malloc
+#define ARENA_BLOCK_SIZE (256 * 1024)
+
+// Alignment of all storage returned by arena_alloc
+#define ARENA_ALIGN (alignof(max_align_t))
+
+// The arena is a list of blocks, the newest one first
+typedef struct arena_block_s {
+    struct arena_block_s *prev;
+    size_t size; // number of bytes in data
+    size_t used; // number of bytes of data handed out
+    alignas(max_align_t) char data[];
+} arena_block_t;
+
+static arena_block_t *current = NULL;
+static size_t bytes_used = 0;
+static size_t bytes_reserved = 0;
+
+// Add a new block with room for at least size bytes to the arena
+static void arena_new_block(size_t size)
+{
+    size_t sz = MAX(ARENA_BLOCK_SIZE, size);
+    arena_block_t *b = (arena_block_t *) malloc(sizeof(arena_block_t) + sz);
+    if (b == NULL) {
+	bail_with_error("No space to grow the arena!");
+    }
+    b->prev = current;
+    b->size = sz;
+    b->used = 0;
+    current = b;
+    bytes_reserved += sz;
+}
+
+// Return a pointer to size bytes of fresh storage,
+// suitably aligned for any type.
+// If there is no space, bail with an error message,
+// so this never returns NULL.
+void *arena_alloc(size_t size)
+{
+    size = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+    if (current == NULL || current->used + size > current->size) {
+	arena_new_block(size);
+    }
+    void *ret = current->data + current->used;
+    current->used += size;
+    bytes_used += size;
+    return ret;
+}
+
+// Requires: s != NULL and s points to at least len characters
+// Return a null-terminated copy of the first len characters of s
+// allocated in the arena.
+char *arena_strndup(const char *s, size_t len)
+{
+    char *ret = (char *) arena_alloc(len + 1);
+    memcpy(ret, s, len);
+    ret[len] = '\0';
+    return ret;
+}
+
+// Requires: s != NULL
+// Return a copy of the string s allocated in the arena.
+char *arena_strdup(const char *s)
+{
+    return arena_strndup(s, strlen(s));
+}
+
+// Free all the storage allocated from the arena.
+// All pointers previously returned by the arena become invalid.
+void arena_release()
+{
+    while (current != NULL) {
+	arena_block_t *prev = current->prev;
+	free(current);
+	current = prev;
+    }
+    bytes_used = 0;
+    bytes_reserved = 0;
+}
+
+// Return the number of bytes handed out by the arena
+// since it was last released.
+size_t arena_bytes_used()
+{
+    return bytes_used;
+}
+
+// Return the number of bytes the arena currently holds from malloc
+// (including space not yet handed out).
+size_t arena_bytes_reserved()
+{
+    return bytes_reserved;
+}
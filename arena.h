@@ -0,0 +1,39 @@
+#ifndef _ARENA_H
+#define _ARENA_H
+
+#include <stddef.h>
+
+// The arena is a bump-pointer allocator for everything that lives
+// as long as one compilation unit: AST nodes, file locations,
+// and the text of tokens.
+// Storage from the arena is never freed individually;
+// arena_release frees all of it at once.
+
+// Return a pointer to size bytes of fresh storage,
+// suitably aligned for any type.
+// If there is no space, bail with an error message,
+// so this never returns NULL.
+extern void *arena_alloc(size_t size);
+
+// Requires: s != NULL and s points to at least len characters
+// Return a null-terminated copy of the first len characters of s
+// allocated in the arena.
+extern char *arena_strndup(const char *s, size_t len);
+
+// Requires: s != NULL
+// Return a copy of the string s allocated in the arena.
+extern char *arena_strdup(const char *s);
+
+// Free all the storage allocated from the arena.
+// All pointers previously returned by the arena become invalid.
+extern void arena_release();
+
+// Return the number of bytes handed out by the arena
+// since it was last released.
+extern size_t arena_bytes_used();
+
+// Return the number of bytes the arena currently holds from malloc
+// (including space not yet handed out).
+extern size_t arena_bytes_reserved();
+
+#endif
@@ -3,22 +3,23 @@
 #include <assert.h>
 #include <stdlib.h>
 #include "utilities.h"
+#include "arena.h"
 #include "ast.h"
 #include "spl.tab.h"
 
 // Return the file location from an AST
-file_location *ast_file_loc(AST t) {
+file_location ast_file_loc(AST t) {
     return t.generic.file_loc;
 }
 
 // Return the filename from the AST t
 const char *ast_filename(AST t) {
-    return ast_file_loc(t)->filename;
+    return file_location_filename(ast_file_loc(t));
 }
 
 // Return the line number from the AST t
 unsigned int ast_line(AST t) {
-    return ast_file_loc(t)->line;
+    return file_location_line(ast_file_loc(t));
 }
 
 // Return the type tag of the AST t
@@ -27,12 +28,9 @@ AST_type ast_type_tag(AST t) {
 }
 
 // Return a pointer to a fresh copy of t
-// that has been allocated on the heap
+// that has been allocated in the arena
 AST *ast_heap_copy(AST t) {
-    AST *ret = (AST *)malloc(sizeof(AST));
-    if (ret == NULL) {
-	bail_with_error("Cannot allocate an AST heap copy!");
-    }
+    AST *ret = (AST *) arena_alloc(sizeof(AST));
     *ret = t;
     return ret;
 }
@@ -43,7 +41,7 @@ block_t ast_block(token_t begin_tok, const_decls_t const_decls,
 		  stmts_t stmts)
 {
     block_t ret;
-    ret.file_loc = file_location_copy(begin_tok.file_loc);
+    ret.file_loc = begin_tok.file_loc;
     ret.type_tag = block_ast;
     ret.const_decls = const_decls;
     ret.var_decls = var_decls;
@@ -59,6 +57,7 @@ extern const_decls_t ast_const_decls_empty(empty_t empty)
     ret.file_loc = empty.file_loc;
     ret.type_tag = const_decls_ast;
     ret.start = NULL;
+    ret.last = NULL;
     return ret;
 }
 
@@ -67,19 +66,16 @@ const_decls_t ast_const_decls(const_decls_t const_decls,
 			      const_decl_t const_decl)
 {
     const_decls_t ret = const_decls;
-    // make a copy of const_decl on the heap
-    const_decl_t *p = (const_decl_t *) malloc(sizeof(const_decl_t));
-    if (p == NULL) {
-	bail_with_error("Cannot allocate space for %s!", "const_decl_t");
-    }
+    // make a copy of const_decl in the arena
+    const_decl_t *p = (const_decl_t *) arena_alloc(sizeof(const_decl_t));
     *p = const_decl;
     p->next = NULL;
-    const_decl_t *last = ast_last_list_elem(ret.start);
-    if (last == NULL) {
+    if (ret.last == NULL) {
 	ret.start = p;
     } else {
-	last->next = p;
+	ret.last->next = p;
     }
+    ret.last = p;
     return ret;
 }
 
@@ -102,13 +98,11 @@ extern const_def_list_t ast_const_def_list_singleton(const_def_t const_def)
     const_def_list_t ret;
     ret.file_loc = const_def.file_loc;
     ret.type_tag = const_def_list_ast;
-    const_def_t *p = (const_def_t *) malloc(sizeof(const_def_t));
-    if (p == NULL) {							
-	bail_with_error("Unable to allocate space for a %s!", "const_def_t"); 
-    }		    
+    const_def_t *p = (const_def_t *) arena_alloc(sizeof(const_def_t));
     *p = const_def;		
     p->next = NULL;    
     ret.start = p;							
+    ret.last = p;
     return ret;
 }
 
@@ -117,19 +111,16 @@ extern const_def_list_t ast_const_def_list(const_def_list_t const_def_list,
 				           const_def_t const_def)
 {
     const_def_list_t ret = const_def_list;
-    // make a copy of const_def on the heap
-    const_def_t *p = (const_def_t *) malloc(sizeof(const_def_t));
-    if (p == NULL) {
-	bail_with_error("Cannot allocate space for %s!", "const_def_t");
-    }
+    // make a copy of const_def in the arena
+    const_def_t *p = (const_def_t *) arena_alloc(sizeof(const_def_t));
     *p = const_def;
     p->next = NULL;
-    const_def_t *last = ast_last_list_elem(ret.start);
-    if (last == NULL) {
+    if (ret.last == NULL) {
 	ret.start = p;
     } else {
-	last->next = p;
+	ret.last->next = p;
     }
+    ret.last = p;
     return ret;
 }
 
@@ -137,8 +128,7 @@ extern const_def_list_t ast_const_def_list(const_def_list_t const_def_list,
 const_def_t ast_const_def(ident_t ident, number_t number)
 {
     const_def_t ret;
-    ret.file_loc = file_location_copy(ident.file_loc);
-    assert((ret.file_loc)->filename != NULL);
+    ret.file_loc = ident.file_loc;
     ret.type_tag = const_def_ast;
     ret.next = NULL;
     ret.ident = ident;
@@ -154,6 +144,7 @@ var_decls_t ast_var_decls_empty(empty_t empty)
     ret.file_loc = empty.file_loc;
     ret.type_tag = var_decls_ast;
     ret.var_decls = NULL;
+    ret.last = NULL;
     return ret;
 }
 
@@ -161,19 +152,16 @@ var_decls_t ast_var_decls_empty(empty_t empty)
 var_decls_t ast_var_decls(var_decls_t var_decls, var_decl_t var_decl)
 {
     var_decls_t ret = var_decls;
-    // make a copy of var_decl on the heap
-    var_decl_t *p = (var_decl_t *) malloc(sizeof(var_decl_t));
-    if (p == NULL) {
-	bail_with_error("Cannot allocate space for %s!", "var_decl_t");
-    }
+    // make a copy of var_decl in the arena
+    var_decl_t *p = (var_decl_t *) arena_alloc(sizeof(var_decl_t));
     *p = var_decl;
     p->next = NULL;
-    var_decl_t *last = ast_last_list_elem(ret.var_decls);
-    if (last == NULL) {
+    if (ret.last == NULL) {
 	ret.var_decls = p;
     } else {
-	last->next = p;
+	ret.last->next = p;
     }
+    ret.last = p;
     return ret;
 }
 
@@ -194,14 +182,12 @@ extern ident_list_t ast_ident_list_singleton(ident_t ident)
     ident_list_t ret;
     ret.file_loc = ident.file_loc;
     ret.type_tag = ident_list_ast;
-    // make a copy of ident on the heap
-    ident_t *p = (ident_t *) malloc(sizeof(ident_t));	
-    if (p == NULL) {							
-	bail_with_error("Unable to allocate space for a %s!", "ident_t"); 
-    }		    
+    // make a copy of ident in the arena
+    ident_t *p = (ident_t *) arena_alloc(sizeof(ident_t));
     *p = ident;		
     p->next = NULL;    
     ret.start = p;						
+    ret.last = p;
     return ret;
 }
 
@@ -209,19 +195,16 @@ extern ident_list_t ast_ident_list_singleton(ident_t ident)
 extern ident_list_t ast_ident_list(ident_list_t ident_list, ident_t ident)
 {
     ident_list_t ret = ident_list;
-    // make a copy of ident on the heap
-    ident_t *p = (ident_t *) malloc(sizeof(ident_t));
-    if (p == NULL) {
-	bail_with_error("Cannot allocate space for %s!", "ident_t");
-    }
+    // make a copy of ident in the arena
+    ident_t *p = (ident_t *) arena_alloc(sizeof(ident_t));
     *p = ident;
     p->next = NULL;
-    ident_t *last = ast_last_list_elem(ret.start);
-    if (last == NULL) {
+    if (ret.last == NULL) {
 	ret.start = p;
     } else {
-	last->next = p;
+	ret.last->next = p;
     }
+    ret.last = p;
     return ret;
 }
 
@@ -232,6 +215,7 @@ proc_decls_t ast_proc_decls_empty(empty_t empty)
     ret.file_loc = empty.file_loc;
     ret.type_tag = proc_decls_ast;
     ret.proc_decls = NULL;
+    ret.last = NULL;
     return ret;
 }
 
@@ -240,19 +224,16 @@ proc_decls_t ast_proc_decls(proc_decls_t proc_decls,
 			    proc_decl_t proc_decl)
 {
     proc_decls_t ret = proc_decls;
-    // make a copy of proc_decl on the heap
-    proc_decl_t *p = (proc_decl_t *) malloc(sizeof(proc_decl_t));	
-    if (p == NULL) {							
-	bail_with_error("Unable to allocate space for a %s!", "proc_decl_t"); 
-    }		    
+    // make a copy of proc_decl in the arena
+    proc_decl_t *p = (proc_decl_t *) arena_alloc(sizeof(proc_decl_t));
     *p = proc_decl;		
     p->next = NULL;    
-    proc_decl_t *last = ast_last_list_elem(ret.proc_decls);
-    if (last == NULL) {
+    if (ret.last == NULL) {
 	ret.proc_decls = p;
     } else {
-	last->next = p;
+	ret.last->next = p;
     }
+    ret.last = p;
     return ret;
 }
 
@@ -260,14 +241,11 @@ proc_decls_t ast_proc_decls(proc_decls_t proc_decls,
 proc_decl_t ast_proc_decl(ident_t ident, block_t block)
 {
     proc_decl_t ret;
-    ret.file_loc = file_location_copy(ident.file_loc);
+    ret.file_loc = ident.file_loc;
     ret.type_tag = proc_decl_ast;
     ret.next = NULL;
     ret.name = ident.name;
-    block_t *p = (block_t *) malloc(sizeof(block_t));
-    if (p == NULL) {
-	bail_with_error("Unable to allocate space for a %s!", "block_t");
-    }
+    block_t *p = (block_t *) arena_alloc(sizeof(block_t));
     *p = block;
     ret.block = p;
     return ret;
@@ -285,9 +263,10 @@ print_stmt_t ast_print_stmt(expr_t expr) {
 // Return an AST for a read statement
 read_stmt_t ast_read_stmt(ident_t ident) {
     read_stmt_t ret;
-    ret.file_loc = file_location_copy(ident.file_loc);
+    ret.file_loc = ident.file_loc;
     ret.type_tag = read_stmt_ast;
     ret.name = ident.name;
+    ret.lex_addr = lexical_address_unresolved();
     return ret;
 }
 
@@ -297,10 +276,7 @@ while_stmt_t ast_while_stmt(condition_t condition, stmts_t body) {
     ret.file_loc = condition.file_loc;
     ret.type_tag = while_stmt_ast;
     ret.condition = condition;
-    stmts_t *p = (stmts_t *) malloc(sizeof(stmts_t));
-    if (p == NULL) {
-	bail_with_error("Unable to allocate space for a %s!", "stmts_t"); 
-    }
+    stmts_t *p = (stmts_t *) arena_alloc(sizeof(stmts_t));
     *p = body;		
     ret.body = p;					
     return ret;
@@ -314,18 +290,12 @@ if_stmt_t ast_if_then_else_stmt(condition_t condition,
     ret.file_loc = condition.file_loc;
     ret.type_tag = if_stmt_ast;
     ret.condition = condition;
-    // copy then_stmt to the heap
-    stmts_t *p = (stmts_t *) malloc(sizeof(stmts_t));			
-    if (p == NULL) {							
-	bail_with_error("Unable to allocate space for a %s!", "stmts_t"); 
-    }									
+    // copy then_stmt to the arena
+    stmts_t *p = (stmts_t *) arena_alloc(sizeof(stmts_t));
     *p = then_stmts;	
     ret.then_stmts = p;						
-    // copy else_stmts to the heap
-    p = (stmts_t *) malloc(sizeof(stmts_t));	
-    if (p == NULL) {							
-	bail_with_error("Unable to allocate space for a %s!", "stmts_t"); 
-    }		    
+    // copy else_stmts to the arena
+    p = (stmts_t *) arena_alloc(sizeof(stmts_t));
     *p = else_stmts;		
     ret.else_stmts = p;						
     return ret;
@@ -339,11 +309,8 @@ extern if_stmt_t ast_if_then_stmt(condition_t condition,
     ret.file_loc = condition.file_loc;
     ret.type_tag = if_stmt_ast;
     ret.condition = condition;
-    // copy then_stmt to the heap
-    stmts_t *p = (stmts_t *) malloc(sizeof(stmts_t));			
-    if (p == NULL) {							
-	bail_with_error("Unable to allocate space for a %s!", "stmts_t"); 
-    }									
+    // copy then_stmt to the arena
+    stmts_t *p = (stmts_t *) arena_alloc(sizeof(stmts_t));
     *p = then_stmts;	
     ret.then_stmts = p;						
     ret.else_stmts = NULL;						
@@ -357,11 +324,8 @@ block_stmt_t ast_block_stmt(block_t block)
     block_stmt_t ret;
     ret.file_loc = block.file_loc;
     ret.type_tag = block_stmt_ast;
-    // copy the block to the heap
-    block_t *p = (block_t *) malloc(sizeof(block_t));			
-    if (p == NULL) {							
-	bail_with_error("Unable to allocate space for a %s!", "block_t"); 
-    }									
+    // copy the block to the arena
+    block_t *p = (block_t *) arena_alloc(sizeof(block_t));
     *p = block;	
     ret.block = p;
     return ret;
@@ -371,9 +335,10 @@ block_stmt_t ast_block_stmt(block_t block)
  call_stmt_t ast_call_stmt(ident_t ident)
 {
     call_stmt_t ret;
-    ret.file_loc = file_location_copy(ident.file_loc);
+    ret.file_loc = ident.file_loc;
     ret.type_tag = call_stmt_ast;
     ret.name = ident.name;
+    ret.lex_addr = lexical_address_unresolved();
     return ret;
 }
 
@@ -381,14 +346,12 @@ block_stmt_t ast_block_stmt(block_t block)
 assign_stmt_t ast_assign_stmt(ident_t ident, expr_t expr)
 {
     assign_stmt_t ret;
-    ret.file_loc = file_location_copy(ident.file_loc);
+    ret.file_loc = ident.file_loc;
     ret.type_tag = assign_stmt_ast;
     ret.name = ident.name;
+    ret.lex_addr = lexical_address_unresolved();
     assert(ret.name != NULL);
-    expr_t *p = (expr_t *) malloc(sizeof(expr_t));
-    if (p == NULL) {
-	bail_with_error("Unable to allocate space for a %s!", "expr_t");
-    }
+    expr_t *p = (expr_t *) arena_alloc(sizeof(expr_t));
     *p = expr;
     ret.expr = p;
     assert(ret.expr != NULL);
@@ -399,14 +362,14 @@ assign_stmt_t ast_assign_stmt(ident_t ident, expr_t expr)
 stmts_t ast_stmts_empty(empty_t empty)
 {
     stmts_t ret;
-    ret.file_loc = file_location_copy(empty.file_loc);
+    ret.file_loc = empty.file_loc;
     ret.type_tag = stmts_ast;
     ret.stmts_kind = empty_stmts_e;
     return ret;
 }
 
 // Return an AST for empty found in the given file location
-empty_t ast_empty(file_location *file_loc)
+empty_t ast_empty(file_location file_loc)
 {
     empty_t ret;
     ret.file_loc = file_loc;
@@ -433,15 +396,13 @@ stmt_list_t ast_stmt_list_singleton(stmt_t stmt) {
     ret.file_loc = stmt.file_loc;
     ret.type_tag = stmt_list_ast;
     stmt.next = NULL;
-    // copy stmt to the heap
-    stmt_t *p = (stmt_t *) malloc(sizeof(stmt_t));	
-    if (p == NULL) {							
-	bail_with_error("Unable to allocate space for a %s!", "stmt_t"); 
-    }		    
+    // copy stmt to the arena
+    stmt_t *p = (stmt_t *) arena_alloc(sizeof(stmt_t));
     *p = stmt;
     p->next = NULL;
     // there will be no statments after stmt in the list
     ret.start = p;					
+    ret.last = p;
     return ret;
 }
 
@@ -449,16 +410,13 @@ stmt_list_t ast_stmt_list_singleton(stmt_t stmt) {
 extern stmt_list_t ast_stmt_list(stmt_list_t stmt_list, stmt_t stmt) {
     // debug_print("Entering ast_stmt_list...\n");
     stmt_list_t ret = stmt_list;
-    // copy stmt to the heap
-    stmt_t *s = (stmt_t *) malloc(sizeof(stmt_t));
-    if (s == NULL) {
-	bail_with_error("Cannot allocate space for %s!", "stmt_t");
-    }
+    // copy stmt to the arena
+    stmt_t *s = (stmt_t *) arena_alloc(sizeof(stmt_t));
     *s = stmt;
     s->next = NULL;
-    stmt_t *last = ast_last_list_elem(ret.start);
-    assert(last != NULL); // because there are no empty lists of stmts
-    last->next = s;
+    assert(ret.last != NULL); // because there are no empty lists of stmts
+    ret.last->next = s;
+    ret.last = s;
     return ret;
 }
 
@@ -601,19 +559,13 @@ binary_op_expr_t ast_binary_op_expr(expr_t expr1, token_t arith_op,
     ret.file_loc = expr1.file_loc;
     ret.type_tag = binary_op_expr_ast;
 
-    expr_t *p = (expr_t *) malloc(sizeof(expr_t));
-    if (p == NULL) {
-	bail_with_error("Unable to allocate space for a %s!", "expr_t");
-    }
+    expr_t *p = (expr_t *) arena_alloc(sizeof(expr_t));
     *p = expr1;
     ret.expr1 = p;
 
     ret.arith_op = arith_op;
     
-    p = (expr_t *) malloc(sizeof(expr_t));
-    if (p == NULL) {
-	bail_with_error("Unable to allocate space for a %s!", "expr_t");
-    }
+    p = (expr_t *) arena_alloc(sizeof(expr_t));
     *p = expr2;
     ret.expr2 = p;
 
@@ -635,7 +587,7 @@ expr_t ast_expr_binary_op(binary_op_expr_t e)
 expr_t ast_expr_signed_expr(token_t sign, expr_t e)
 {
     expr_t ret;
-    ret.file_loc = file_location_copy(sign.file_loc);
+    ret.file_loc = sign.file_loc;
     ret.type_tag = expr_ast;
     switch (sign.code) {
     case minussym:
@@ -662,7 +614,7 @@ expr_t ast_expr_signed_expr(token_t sign, expr_t e)
 expr_t ast_expr_pos_number(token_t sign, number_t number)
 {
     expr_t ret;
-    ret.file_loc = file_location_copy(sign.file_loc);
+    ret.file_loc = sign.file_loc;
     ret.type_tag = expr_ast;
     ret.expr_kind = expr_number;
     ret.data.number = number;
@@ -670,7 +622,7 @@ expr_t ast_expr_pos_number(token_t sign, number_t number)
 }
 
 // Return an AST for the given token
-token_t ast_token(file_location *file_loc, const char *text, int code)
+token_t ast_token(file_location file_loc, const char *text, int code)
 {
     token_t ret;
     ret.file_loc = file_loc;
@@ -684,19 +636,20 @@ token_t ast_token(file_location *file_loc, const char *text, int code)
 number_t ast_number(token_t sgn, word_type value)
 {
     number_t ret;
-    ret.file_loc = file_location_copy(sgn.file_loc);
+    ret.file_loc = sgn.file_loc;
     ret.type_tag = number_ast;
     ret.value = value;
     return ret;
 }
 
 // Return an AST for an identifier
-ident_t ast_ident(file_location *file_loc, const char *name)
+ident_t ast_ident(file_location file_loc, const char *name)
 {
     ident_t ret;
     ret.file_loc = file_loc;
     ret.type_tag = ident_ast;
     ret.name = name;
+    ret.lex_addr = lexical_address_unresolved();
     return ret;
 }
 
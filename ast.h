@@ -4,6 +4,7 @@
 #include <stdbool.h>
 #include "machine_types.h"
 #include "file_location.h"
+#include "lexical_address.h"
 
 // types of ASTs (type tags)
 typedef enum
@@ -49,7 +50,7 @@ typedef enum
 // should be in all alternatives for ASTs.
 typedef struct
 {
-    file_location *file_loc;
+    file_location file_loc;
     AST_type type_tag; // says what field of the union is active
     void *next;        // for lists
 } generic_t;
@@ -57,23 +58,24 @@ typedef struct
 // empty ::=
 typedef struct
 {
-    file_location *file_loc;
+    file_location file_loc;
     AST_type type_tag;
 } empty_t;
 
 // identifiers
 typedef struct ident_s
 {
-    file_location *file_loc;
+    file_location file_loc;
     AST_type type_tag;
     struct ident_s *next; // for lists this is a part of
     const char *name;
+    lexical_address lex_addr; // of a use, set by scope checking
 } ident_t;
 
 // (possibly signed) numbers
 typedef struct
 {
-    file_location *file_loc;
+    file_location file_loc;
     AST_type type_tag;
     const char *text;
     word_type value;
@@ -82,7 +84,7 @@ typedef struct
 // tokens as ASTs
 typedef struct
 {
-    file_location *file_loc;
+    file_location file_loc;
     AST_type type_tag;
     const char *text;
     int code;
@@ -104,7 +106,7 @@ struct expr_s;
 // arithOp ::= + | - | * | /
 typedef struct
 {
-    file_location *file_loc;
+    file_location file_loc;
     AST_type type_tag;
     struct expr_s *expr1;
     token_t arith_op;
@@ -114,7 +116,7 @@ typedef struct
 // expr ::= - expr
 typedef struct
 {
-    file_location *file_loc;
+    file_location file_loc;
     AST_type type_tag;
     struct expr_s *expr;
 } negated_expr_t;
@@ -122,7 +124,7 @@ typedef struct
 // expr ::= expr arithOp expr | ident | number
 typedef struct expr_s
 {
-    file_location *file_loc;
+    file_location file_loc;
     AST_type type_tag;
     expr_kind_e expr_kind;
     union
@@ -143,7 +145,7 @@ typedef enum
 
 typedef struct
 {
-    file_location *file_loc;
+    file_location file_loc;
     AST_type type_tag;
     expr_t dividend;
     expr_t divisor;
@@ -151,7 +153,7 @@ typedef struct
 
 typedef struct
 {
-    file_location *file_loc;
+    file_location file_loc;
     AST_type type_tag;
     expr_t expr1;
     token_t rel_op;
@@ -161,7 +163,7 @@ typedef struct
 // condition ::= divisible expr expr | expr relOp expr
 typedef struct
 {
-    file_location *file_loc;
+    file_location file_loc;
     AST_type type_tag;
     condition_kind_e cond_kind;
     union cond_u
@@ -189,9 +191,10 @@ struct stmt_s;
 // stmt-list ::= stmt | stmt-list stmt
 typedef struct
 {
-    file_location *file_loc;
+    file_location file_loc;
     AST_type type_tag;
     struct stmt_s *start;
+    struct stmt_s *last; // last element, for appending in constant time
 } stmt_list_t;
 
 typedef enum
@@ -203,7 +206,7 @@ typedef enum
 // stmts ::= { stmts }
 typedef struct
 {
-    file_location *file_loc;
+    file_location file_loc;
     AST_type type_tag;
     stmts_kind_e stmts_kind;
     stmt_list_t stmt_list; // when stmts_kind != empty_stmts_e
@@ -212,18 +215,20 @@ typedef struct
 // stmt ::= ident := expr
 typedef struct
 {
-    file_location *file_loc;
+    file_location file_loc;
     AST_type type_tag;
     const char *name;
+    lexical_address lex_addr; // of name, set by scope checking
     struct expr_s *expr;
 } assign_stmt_t;
 
 // stmt ::= call ident
 typedef struct
 {
-    file_location *file_loc;
+    file_location file_loc;
     AST_type type_tag;
     const char *name;
+    lexical_address lex_addr; // of name, set by scope checking
 } call_stmt_t;
 
 // forward declaration for block type
@@ -232,7 +237,7 @@ struct block_s;
 // block-stmt ::= block
 typedef struct block_stmt_s
 {
-    file_location *file_loc;
+    file_location file_loc;
     AST_type type_tag;
     struct block_s *block;
 } block_stmt_t;
@@ -240,7 +245,7 @@ typedef struct block_stmt_s
 // if-stmt ::= if condition stmts stmts | if condition stmts
 typedef struct
 {
-    file_location *file_loc;
+    file_location file_loc;
     AST_type type_tag;
     condition_t condition;
     stmts_t *then_stmts;
@@ -250,7 +255,7 @@ typedef struct
 // stmt ::= while condition stmt
 typedef struct
 {
-    file_location *file_loc;
+    file_location file_loc;
     AST_type type_tag;
     condition_t condition;
     stmts_t *body;
@@ -259,15 +264,16 @@ typedef struct
 // stmt ::= read ident
 typedef struct
 {
-    file_location *file_loc;
+    file_location file_loc;
     AST_type type_tag;
     const char *name;
+    lexical_address lex_addr; // of name, set by scope checking
 } read_stmt_t;
 
 // stmt ::= print expr
 typedef struct
 {
-    file_location *file_loc;
+    file_location file_loc;
     AST_type type_tag;
     expr_t expr;
 } print_stmt_t;
@@ -276,7 +282,7 @@ typedef struct
 //        | while-stmt | read-stmt | print-stmt | block-stmt
 typedef struct stmt_s
 {
-    file_location *file_loc;
+    file_location file_loc;
     AST_type type_tag;
     struct stmt_s *next; // for lists this is a part of
     stmt_kind_e stmt_kind;
@@ -295,7 +301,7 @@ typedef struct stmt_s
 // procDecl ::= proc ident block
 typedef struct proc_decl_s
 {
-    file_location *file_loc;
+    file_location file_loc;
     AST_type type_tag;
     struct proc_decl_s *next; // for lists
     const char *name;
@@ -305,23 +311,25 @@ typedef struct proc_decl_s
 // proc-decls ::= { proc-decl }
 typedef struct
 {
-    file_location *file_loc;
+    file_location file_loc;
     AST_type type_tag;
     proc_decl_t *proc_decls;
+    proc_decl_t *last; // last element (NULL if empty)
 } proc_decls_t;
 
 // ident-list ::= ident | ident-list ident
 typedef struct
 {
-    file_location *file_loc;
+    file_location file_loc;
     AST_type type_tag;
     ident_t *start;
+    ident_t *last; // last element, for appending in constant time
 } ident_list_t;
 
 // var-decl ::= var ident-list
 typedef struct var_decl_s
 {
-    file_location *file_loc;
+    file_location file_loc;
     AST_type type_tag;
     struct var_decl_s *next; // for lists this is a part of
     ident_list_t ident_list;
@@ -330,15 +338,16 @@ typedef struct var_decl_s
 // var-decls ::= { var-decl }
 typedef struct
 {
-    file_location *file_loc;
+    file_location file_loc;
     AST_type type_tag;
     var_decl_t *var_decls;
+    var_decl_t *last; // last element (NULL if empty)
 } var_decls_t;
 
 // const-def ::= ident number
 typedef struct const_def_s
 {
-    file_location *file_loc;
+    file_location file_loc;
     AST_type type_tag;
     struct const_def_s *next; // for lists this is a part of
     ident_t ident;
@@ -348,15 +357,16 @@ typedef struct const_def_s
 // const-def-list ::= { const-def }
 typedef struct
 {
-    file_location *file_loc;
+    file_location file_loc;
     AST_type type_tag;
     const_def_t *start;
+    const_def_t *last; // last element, for appending in constant time
 } const_def_list_t;
 
 // const-decl ::= const const-def-list
 typedef struct const_decl_s
 {
-    file_location *file_loc;
+    file_location file_loc;
     AST_type type_tag;
     struct const_decl_s *next; // for lists this is a part of
     const_def_list_t const_def_list;
@@ -365,15 +375,16 @@ typedef struct const_decl_s
 // const-decls ::= { const-decl }
 typedef struct
 {
-    file_location *file_loc;
+    file_location file_loc;
     AST_type type_tag;
     const_decl_t *start;
+    const_decl_t *last; // last element (NULL if empty)
 } const_decls_t;
 
 // block ::= begin const-decls var-decls proc-decls stmts
 typedef struct block_s
 {
-    file_location *file_loc;
+    file_location file_loc;
     AST_type type_tag;
     const_decls_t const_decls;
     var_decls_t var_decls;
@@ -419,7 +430,7 @@ typedef union AST_u
 } AST;
 
 // Return the file location from an AST
-extern file_location *ast_file_loc(AST t);
+extern file_location ast_file_loc(AST t);
 
 // Return the filename from the AST t
 extern const char *ast_filename(AST t);
@@ -431,7 +442,7 @@ extern unsigned int ast_line(AST t);
 extern AST_type ast_type_tag(AST t);
 
 // Return a pointer to a fresh copy of t
-// that has been allocated on the heap
+// that has been allocated in the arena (see arena.h)
 extern AST *ast_heap_copy(AST t);
 
 // Return an AST for a block which contains the given ASTs.
@@ -486,7 +497,7 @@ extern proc_decl_t ast_proc_decl(ident_t ident, block_t block);
 extern stmts_t ast_stmts_empty(empty_t empty);
 
 // Return an AST for empty found in the given file location
-extern empty_t ast_empty(file_location *file_loc);
+extern empty_t ast_empty(file_location file_loc);
 
 // Return an AST for the list of statements
 extern stmts_t ast_stmts(stmt_list_t stmt_list);
@@ -576,11 +587,11 @@ extern expr_t ast_expr_signed_expr(token_t sign, expr_t expr);
 // The following are made by the lexer...
 
 // Return an AST for the given token
-extern token_t ast_token(file_location *file_loc, const char *text, int code);
+extern token_t ast_token(file_location file_loc, const char *text, int code);
 
 // Return an AST for an identifier
 // found in the file named fn, on line ln, with the given name.
-extern ident_t ast_ident(file_location *file_loc, const char *name);
+extern ident_t ast_ident(file_location file_loc, const char *name);
 
 // Some operations on AST lists
 
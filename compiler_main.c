@@ -1,5 +1,15 @@
+#define _DEFAULT_SOURCE  // for fork, fileno, and MAP_ANONYMOUS
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <setjmp.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
 #include "parser.h"
 #include "lexer.h"
 #include "ast.h"
@@ -7,40 +17,475 @@
 #include "unparser.h"
 #include "symtab.h"
 #include "scope_check.h"
+#include "arena.h"
+#include "file_location.h"
+#include "flat_ast.h"
+#include "intern.h"
+#include "stats.h"
 
+// longest line allowed in a list file
+#define MAX_LIST_LINE 4096
+
+// size of the buffer used to copy a worker's output
+#define COPY_BUF_SIZE 65536
+
+// the names of the files to compile, in order
+static const char **file_names = NULL;
+static unsigned int num_file_names = 0;
+static unsigned int file_names_capacity = 0;
+
+// What to do with each file
+typedef struct {
+    bool use_flat_ast;  // check (and unparse) a flat copy of the AST
+    bool unparse;       // unparse the AST
+    bool check;         // scope check the AST
+    bool show_addresses; // unparse after checking, with lexical addresses
+    FILE *unparse_out;  // where the unparsed program goes
+} compile_options_t;
+
+// the flat AST of the file being compiled (if any),
+// so that it can be freed if an error stops the compilation
+static flat_ast_t *flat_ast = NULL;
 
 /* Print a usage message on stderr 
    and exit with failure. */
 static void usage(const char *cmdname)
 {
     fprintf(stderr,
-	    "Usage: %s file.spl\n",
+	    "Usage: %s [--flat] [-j N] [--max-errors N]"
+	    " [--check-only | --unparse-only | --addresses] [-o outfile]"
+	    " [--stats | --stats=json] file.spl..."
+	    " (or @listfile for the files named in listfile)\n",
 	    cmdname);
     exit(EXIT_FAILURE);
 }
 
-int main(int argc, char *argv[])
+// Return the value of num, which must be a decimal number
+// that is at least min, otherwise print a usage message and exit
+static unsigned int count_arg(const char *cmdname, const char *num,
+			      long min)
 {
-    const char *cmdname = argv[0];
-    --argc;
-    /* 1 non-option argument */
-    if (argc != 1 || argv[1][0] == '-') {
-	    usage(cmdname);
+    char *end;
+    long n = strtol(num, &end, 10);
+    if (*num == '\0' || *end != '\0' || n < min) {
+	usage(cmdname);
+    }
+    return (unsigned int) n;
+}
+
+// Add name to the end of the list of files to compile
+static void add_file_name(const char *name)
+{
+    if (num_file_names == file_names_capacity) {
+	file_names_capacity = (file_names_capacity == 0)
+	    ? 16 : 2 * file_names_capacity;
+	file_names = (const char **)
+	    realloc(file_names, file_names_capacity * sizeof(const char *));
+	if (file_names == NULL) {
+	    bail_with_error("No space for the list of files!");
+	}
+    }
+    file_names[num_file_names++] = name;
+}
+
+// Add the files named in the file listname (one per line,
+// ignoring blank lines) to the end of the list of files to compile
+static void add_list_file(const char *listname)
+{
+    FILE *lf = fopen(listname, "r");
+    if (lf == NULL) {
+	bail_with_error("Cannot open list file %s", listname);
+    }
+    char line[MAX_LIST_LINE];
+    while (fgets(line, MAX_LIST_LINE, lf) != NULL) {
+	size_t len = strlen(line);
+	if (len == MAX_LIST_LINE - 1 && line[len-1] != '\n') {
+	    bail_with_error("Line too long in list file %s", listname);
+	}
+	while (len > 0 && (line[len-1] == '\n' || line[len-1] == '\r'
+			   || line[len-1] == ' ' || line[len-1] == '\t')) {
+	    len--;
+	}
+	if (len > 0) {
+	    // the interned copy is never freed
+	    add_file_name(intern_string_n(line, len));
+	}
+    }
+    fclose(lf);
+}
+
+// Parse the file named fname, then unparse and/or scope check it
+// as the options say.
+// Return 0 if there were no errors, otherwise the exit code
+// that the errors would have caused.
+static int compile_file(const char *fname, const compile_options_t *opts)
+{
+    jmp_buf on_error;
+    int rc = setjmp(on_error);
+    if (rc != 0) {
+	// an error was reported, so clean up after this file
+	set_error_recovery(NULL);
+	if (flat_ast != NULL) {
+	    stats_count_flat_ast_bytes(flat_ast_bytes(flat_ast));
+	    flat_ast_free(flat_ast);
+	    flat_ast = NULL;
+	}
+	stats_count_arena_bytes(arena_bytes_used());
+	arena_release();
+	file_location_release();
+	return rc;
     }
+    set_error_recovery(&on_error);
+    errno = 0;
+    reset_prog_errors();
+    stats_count_file();
 
-    lexer_init(argv[1]);
+    lexer_init((char *) fname);
 
     // parsing
-    block_t progast = parseProgram(argv[1]);
+    stats_phase_start(stats_parse);
+    block_t progast = parseProgram(fname);
+    stats_phase_end(stats_parse);
+    if (stats_enabled()) {
+	stats_count_ast(&progast);
+    }
+
+    if (opts->use_flat_ast) {
+	// copy the AST into flat arrays and check that instead
+	stats_phase_start(stats_flatten);
+	flat_ast = flat_ast_build(&progast);
+	stats_phase_end(stats_flatten);
+	stats_count_arena_bytes(arena_bytes_used());
+	arena_release();
+	if (opts->unparse && !opts->show_addresses) {
+	    stats_phase_start(stats_unparse);
+	    unparseFlatProgram(opts->unparse_out, flat_ast);
+	    stats_phase_end(stats_unparse);
+	}
+	if (opts->check) {
+	    stats_phase_start(stats_check);
+	    symtab_initialize();
+	    scope_check_flat_program(flat_ast);
+	    stats_phase_end(stats_check);
+	}
+	if (opts->unparse && opts->show_addresses) {
+	    stats_phase_start(stats_unparse);
+	    unparseFlatProgram(opts->unparse_out, flat_ast);
+	    stats_phase_end(stats_unparse);
+	}
+	stats_count_flat_ast_bytes(flat_ast_bytes(flat_ast));
+	flat_ast_free(flat_ast);
+	flat_ast = NULL;
+	// the flat AST was the last user of the file's locations
+	file_location_release();
+    } else {
+	if (opts->unparse && !opts->show_addresses) {
+	    // unparse to check on the AST
+	    stats_phase_start(stats_unparse);
+	    unparseProgram(opts->unparse_out, &progast);
+	    stats_phase_end(stats_unparse);
+	}
+
+	if (opts->check) {
+	    stats_phase_start(stats_check);
+
+	    // initialize symbol table
+	    symtab_initialize();
+
+	    // perform scope checking
+	    scope_check_program(&progast);
+
+	    stats_phase_end(stats_check);
+	}
+
+	if (opts->unparse && opts->show_addresses) {
+	    // unparse to check on the lexical addresses found by checking
+	    stats_phase_start(stats_unparse);
+	    unparseProgram(opts->unparse_out, &progast);
+	    stats_phase_end(stats_unparse);
+	}
 
-    // unparse to check on the AST
-    unparseProgram(stdout, progast);
+	// release the AST and everything else made for this file
+	stats_count_arena_bytes(arena_bytes_used());
+	arena_release();
+	file_location_release();
+    }
+    if (prog_error_count() > 0) {
+	// the errors were reported, but not all stopped the checking
+	exit_with_error(EXIT_FAILURE);
+    }
 
-    // initialize symbol table
-    symtab_initialize();
+    set_error_recovery(NULL);
+    return 0;
+}
 
-    // perform scope checking
-    scope_check_program(progast);
+// What a worker process found when compiling one file.
+// The file's standard output and standard error were written
+// to the worker's own temporary files, at the given offsets.
+typedef struct {
+    bool done;  // false if the worker stopped before finishing the file
+    int rc;     // result of compile_file
+    unsigned int worker;
+    off_t out_start, out_end;
+    off_t err_start, err_end;
+} file_result_t;
 
-    return EXIT_SUCCESS;
+// The memory shared by the driver and its worker processes
+typedef struct {
+    atomic_uint next_file;  // index of the next file to be compiled
+    stats_t *worker_stats;  // one for each worker (after the results)
+    file_result_t results[]; // one for each file name
+} shared_state_t;
+
+// Return the current offset of the file descriptor fd
+static off_t current_offset(int fd)
+{
+    fflush(NULL);
+    return lseek(fd, 0, SEEK_CUR);
+}
+
+// Run as worker number w, taking files from shared until none remain,
+// with standard output going to out and standard error to err.
+// The unparsed programs also go to out (instead of opts->unparse_out).
+// This does not return.
+static void run_worker(shared_state_t *shared, unsigned int w,
+		       const compile_options_t *opts, FILE *out, FILE *err)
+{
+    if (dup2(fileno(out), STDOUT_FILENO) < 0
+	|| dup2(fileno(err), STDERR_FILENO) < 0) {
+	_exit(EXIT_FAILURE);
+    }
+    compile_options_t worker_opts = *opts;
+    worker_opts.unparse_out = stdout;
+    for (;;) {
+	unsigned int i = atomic_fetch_add(&shared->next_file, 1);
+	if (i >= num_file_names) {
+	    break;
+	}
+	file_result_t *r = &shared->results[i];
+	r->worker = w;
+	r->out_start = current_offset(STDOUT_FILENO);
+	r->err_start = current_offset(STDERR_FILENO);
+	r->rc = compile_file(file_names[i], &worker_opts);
+	r->out_end = current_offset(STDOUT_FILENO);
+	r->err_end = current_offset(STDERR_FILENO);
+	r->done = true;
+    }
+    stats_get(&shared->worker_stats[w]);
+    fflush(NULL);
+    _exit(EXIT_SUCCESS);
+}
+
+// Copy the bytes from offset start up to offset end of the file from
+// to the stream to
+static void copy_output(FILE *from, off_t start, off_t end, FILE *to)
+{
+    static char buf[COPY_BUF_SIZE];
+    while (start < end) {
+	size_t want = (end - start < COPY_BUF_SIZE)
+	    ? (size_t) (end - start) : COPY_BUF_SIZE;
+	ssize_t got = pread(fileno(from), buf, want, start);
+	if (got <= 0) {
+	    bail_with_error("Cannot read a worker's output!");
+	}
+	fwrite(buf, 1, (size_t) got, to);
+	start += got;
+    }
+    fflush(to);
+}
+
+// Compile all the files using num_workers worker processes,
+// then print each file's output and result in the order given
+// (just as in the sequential batch mode).
+// Return the number of files that had errors.
+static unsigned int compile_files_in_parallel(unsigned int num_workers,
+					      const compile_options_t *opts)
+{
+    size_t results_size = sizeof(shared_state_t)
+	+ num_file_names * sizeof(file_result_t);
+    // put the workers' statistics after the results, suitably aligned
+    results_size = (results_size + sizeof(stats_t) - 1)
+	/ sizeof(stats_t) * sizeof(stats_t);
+    size_t shared_size = results_size + num_workers * sizeof(stats_t);
+    shared_state_t *shared = (shared_state_t *)
+	mmap(NULL, shared_size, PROT_READ | PROT_WRITE,
+	     MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) {
+	bail_with_error("Cannot allocate memory shared with workers!");
+    }
+    // the mapping starts out zeroed, so no file is done yet
+    atomic_init(&shared->next_file, 0);
+    shared->worker_stats = (stats_t *) ((char *) shared + results_size);
+
+    FILE **outs = (FILE **) malloc(2 * num_workers * sizeof(FILE *));
+    if (outs == NULL) {
+	bail_with_error("No space for the workers' output files!");
+    }
+    FILE **errs = outs + num_workers;
+    fflush(NULL);
+    for (unsigned int w = 0; w < num_workers; w++) {
+	outs[w] = tmpfile();
+	errs[w] = tmpfile();
+	if (outs[w] == NULL || errs[w] == NULL) {
+	    bail_with_error("Cannot create a worker's output files");
+	}
+	pid_t pid = fork();
+	if (pid < 0) {
+	    bail_with_error("Cannot start a worker process");
+	} else if (pid == 0) {
+	    run_worker(shared, w, opts, outs[w], errs[w]);
+	}
+    }
+    while (wait(NULL) > 0) {
+	// wait for all the workers
+    }
+    for (unsigned int w = 0; w < num_workers; w++) {
+	stats_add(&shared->worker_stats[w]);
+    }
+
+    unsigned int num_failed = 0;
+    for (unsigned int i = 0; i < num_file_names; i++) {
+	const file_result_t *r = &shared->results[i];
+	if (!r->done) {
+	    fprintf(stderr, "%s: worker process stopped unexpectedly\n",
+		    file_names[i]);
+	    fflush(stderr);
+	    num_failed++;
+	    printf("%s: errors\n", file_names[i]);
+	    continue;
+	}
+	copy_output(outs[r->worker], r->out_start, r->out_end,
+		    opts->unparse_out);
+	copy_output(errs[r->worker], r->err_start, r->err_end, stderr);
+	if (r->rc != 0) {
+	    num_failed++;
+	}
+	printf("%s: %s\n", file_names[i], (r->rc == 0) ? "ok" : "errors");
+	fflush(stdout);
+    }
+
+    for (unsigned int w = 0; w < num_workers; w++) {
+	fclose(outs[w]);
+	fclose(errs[w]);
+    }
+    free(outs);
+    munmap(shared, shared_size);
+    return num_failed;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *cmdname = argv[0];
+    compile_options_t opts = { .use_flat_ast = false,
+			       .unparse = true, .check = true,
+			       .show_addresses = false,
+			       .unparse_out = stdout };
+    const char *out_name = NULL;
+    bool print_stats = false;
+    bool stats_as_json = false;
+    unsigned int num_workers = 1;
+    for (int i = 1; i < argc; i++) {
+	if (strcmp(argv[i], "--flat") == 0) {
+	    opts.use_flat_ast = true;
+	} else if (strcmp(argv[i], "--check-only") == 0) {
+	    // parse and scope check, but do not unparse
+	    opts.unparse = false;
+	} else if (strcmp(argv[i], "--unparse-only") == 0) {
+	    // parse and unparse, but do not scope check
+	    opts.check = false;
+	} else if (strcmp(argv[i], "--addresses") == 0) {
+	    // unparse after checking (or instead of it, with --unparse-only),
+	    // showing the lexical address of each use of a name
+	    opts.show_addresses = true;
+	    unparseShowAddresses(true);
+	} else if (strcmp(argv[i], "-o") == 0) {
+	    // write the unparsed programs to the named file
+	    if (i + 1 >= argc) {
+		usage(cmdname);
+	    }
+	    out_name = argv[++i];
+	} else if (strcmp(argv[i], "--stats") == 0
+		   || strcmp(argv[i], "--stats=json") == 0) {
+	    // print statistics about the run on stderr at the end
+	    print_stats = true;
+	    stats_as_json = (argv[i][7] == '=');
+	} else if (strncmp(argv[i], "-j", 2) == 0) {
+	    // -j N or -jN
+	    const char *num = argv[i] + 2;
+	    if (*num == '\0') {
+		if (i + 1 >= argc) {
+		    usage(cmdname);
+		}
+		num = argv[++i];
+	    }
+	    num_workers = count_arg(cmdname, num, 1);
+	} else if (strcmp(argv[i], "--max-errors") == 0) {
+	    // report up to N errors per file (0 means all of them)
+	    if (i + 1 >= argc) {
+		usage(cmdname);
+	    }
+	    set_error_limit(count_arg(cmdname, argv[++i], 0));
+	} else if (argv[i][0] == '-') {
+	    usage(cmdname);
+	} else if (argv[i][0] == '@') {
+	    add_list_file(argv[i] + 1);
+	} else {
+	    add_file_name(argv[i]);
+	}
+    }
+    if (num_file_names == 0 || (!opts.unparse && !opts.check)
+	|| (!opts.unparse && (out_name != NULL || opts.show_addresses))) {
+	usage(cmdname);
+    }
+    if (out_name != NULL) {
+	opts.unparse_out = fopen(out_name, "w");
+	if (opts.unparse_out == NULL) {
+	    bail_with_error("Cannot open output file %s", out_name);
+	}
+    }
+    if (print_stats) {
+	stats_enable();
+    }
+
+    if (num_file_names == 1) {
+	// just the file's own output
+	int rc = compile_file(file_names[0], &opts);
+	if (out_name != NULL) {
+	    fclose(opts.unparse_out);
+	}
+	if (print_stats) {
+	    fflush(stdout);
+	    stats_print(stderr, stats_as_json);
+	}
+	return (rc == 0) ? EXIT_SUCCESS : rc;
+    }
+
+    // batch mode: report the result for each file, and then a summary
+    unsigned int num_failed = 0;
+    if (num_workers > num_file_names) {
+	num_workers = num_file_names;
+    }
+    if (num_workers > 1) {
+	num_failed = compile_files_in_parallel(num_workers, &opts);
+    } else {
+	for (unsigned int i = 0; i < num_file_names; i++) {
+	    int rc = compile_file(file_names[i], &opts);
+	    fflush(opts.unparse_out);
+	    fflush(stderr);
+	    if (rc != 0) {
+		num_failed++;
+	    }
+	    printf("%s: %s\n", file_names[i], (rc == 0) ? "ok" : "errors");
+	    fflush(stdout);
+	}
+    }
+    if (out_name != NULL) {
+	fclose(opts.unparse_out);
+    }
+    printf("%u files checked, %u with errors\n", num_file_names, num_failed);
+    if (print_stats) {
+	fflush(stdout);
+	stats_print(stderr, stats_as_json);
+    }
+    return (num_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -5,30 +5,123 @@
 #include "file_location.h"
 #include "utilities.h"
 
-// Requires: filename != NULL
-// Return a (pointer to a) fresh file_location with the given
-// information
-file_location *file_location_make(const char *filename,
-					 unsigned int line)
-{
-    file_location *ret = (file_location *) malloc(sizeof(file_location));
-    if (ret == NULL) {
-	bail_with_error("Could not allocate space for a file_location!");
+// Information about a file that locations can refer to.
+// line_starts[i] is the offset of the first character of line i+1,
+// so line_starts[0] is always 0.
+typedef struct {
+    const char *filename;
+    unsigned int *line_starts;
+    unsigned int num_lines;
+    unsigned int lines_capacity;
+} file_info_t;
+
+// the table of files, indexed by file_id
+static file_info_t *files = NULL;
+static unsigned int num_files = 0;
+static unsigned int files_capacity = 0;
+
+// Requires: filename != NULL and filename stays valid
+// Register the file with the given name (with an empty line table)
+// and return its number, for use in file_location_make.
+unsigned int file_location_add_file(const char *filename)
+{
+    if (num_files == files_capacity) {
+	files_capacity = (files_capacity == 0) ? 8 : 2 * files_capacity;
+	files = (file_info_t *) realloc(files,
+					files_capacity * sizeof(file_info_t));
+	if (files == NULL) {
+	    bail_with_error("Could not allocate space for the file table!");
+	}
     }
-    ret->filename = filename;
-    ret->line = line;
-    return ret;
+    file_info_t *fi = &files[num_files];
+    fi->filename = filename;
+    fi->lines_capacity = 64;
+    fi->line_starts = (unsigned int *)
+	malloc(fi->lines_capacity * sizeof(unsigned int));
+    if (fi->line_starts == NULL) {
+	bail_with_error("Could not allocate space for a line table!");
+    }
+    fi->line_starts[0] = 0;
+    fi->num_lines = 1;
+    return num_files++;
 }
 
-// Requires: fl != NULL
-// Return a (pointer to a) fresh copy of fl
-file_location *file_location_copy(file_location *fl)
+// Requires: file_id was returned by file_location_add_file
+//           and offset is greater than that of any previous call
+//           for file_id
+// Record that a line starts at the given offset in the file file_id
+// (i.e., that offset is just after a newline).
+void file_location_note_line_start(unsigned int file_id, unsigned int offset)
 {
-    file_location *ret = (file_location *) malloc(sizeof(file_location));
-    if (ret == NULL) {
-	bail_with_error("Could not allocate space for a file_location!");
+    assert(file_id < num_files);
+    file_info_t *fi = &files[file_id];
+    if (fi->num_lines == fi->lines_capacity) {
+	fi->lines_capacity *= 2;
+	fi->line_starts = (unsigned int *)
+	    realloc(fi->line_starts, fi->lines_capacity * sizeof(unsigned int));
+	if (fi->line_starts == NULL) {
+	    bail_with_error("Could not allocate space for a line table!");
+	}
     }
-    ret->filename = fl->filename;
-    ret->line = fl->line;
+    fi->line_starts[fi->num_lines++] = offset;
+}
+
+// Requires: file_id was returned by file_location_add_file
+// Return a file_location for the given offset in the file file_id
+file_location file_location_make(unsigned int file_id, unsigned int offset)
+{
+    file_location ret;
+    ret.file_id = file_id;
+    ret.offset = offset;
     return ret;
 }
+
+// Return the name of the file of fl
+const char *file_location_filename(file_location fl)
+{
+    assert(fl.file_id < num_files);
+    return files[fl.file_id].filename;
+}
+
+// Return the index in fl's line table of the line containing fl
+static unsigned int file_location_line_index(file_location fl)
+{
+    assert(fl.file_id < num_files);
+    const file_info_t *fi = &files[fl.file_id];
+    // binary search for the last line starting at or before fl.offset
+    unsigned int lo = 0;
+    unsigned int hi = fi->num_lines;
+    while (hi - lo > 1) {
+	unsigned int mid = lo + (hi - lo) / 2;
+	if (fi->line_starts[mid] <= fl.offset) {
+	    lo = mid;
+	} else {
+	    hi = mid;
+	}
+    }
+    return lo;
+}
+
+// Return the (1-based) line number of fl
+unsigned int file_location_line(file_location fl)
+{
+    return file_location_line_index(fl) + 1;
+}
+
+// Return the (1-based) column number of fl
+unsigned int file_location_column(file_location fl)
+{
+    unsigned int i = file_location_line_index(fl);
+    return fl.offset - files[fl.file_id].line_starts[i] + 1;
+}
+
+// Forget all the files registered by file_location_add_file,
+// freeing their line tables, so that file numbers start again from 0.
+// (The table of files itself is kept, to be reused.)
+void file_location_release()
+{
+    for (unsigned int i = 0; i < num_files; i++) {
+	free(files[i].line_starts);
+    }
+    num_files = 0;
+}
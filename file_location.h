@@ -3,19 +3,45 @@
 #define _FILE_LOCATION_H
 
 // location in a source file (useful for error messages)
+// A location is stored compactly, by value, as the number of a file
+// (see file_location_add_file) and a byte offset in that file.
+// The line (and column) are computed from the file's line table
+// only when they are needed.
 typedef struct {
-    const char *filename;
-    unsigned int line; // of first token
+    unsigned int file_id;
+    unsigned int offset; // of first character of the first token
 } file_location;
 
-// Requires: filename != NULL
-// Return a (pointer to a) fresh file_location with the given
-// information
-extern file_location *file_location_make(const char *filename,
-					 unsigned int line);
+// Requires: filename != NULL and filename stays valid
+// Register the file with the given name (with an empty line table)
+// and return its number, for use in file_location_make.
+extern unsigned int file_location_add_file(const char *filename);
 
-// Requires: fl != NULL
-// Return a (pointer to a) fresh copy of fl
-extern file_location *file_location_copy(file_location *fl);
+// Requires: file_id was returned by file_location_add_file
+//           and offset is greater than that of any previous call
+//           for file_id
+// Record that a line starts at the given offset in the file file_id
+// (i.e., that offset is just after a newline).
+extern void file_location_note_line_start(unsigned int file_id,
+					  unsigned int offset);
+
+// Requires: file_id was returned by file_location_add_file
+// Return a file_location for the given offset in the file file_id
+extern file_location file_location_make(unsigned int file_id,
+					unsigned int offset);
+
+// Return the name of the file of fl
+extern const char *file_location_filename(file_location fl);
+
+// Return the (1-based) line number of fl
+extern unsigned int file_location_line(file_location fl);
+
+// Return the (1-based) column number of fl
+extern unsigned int file_location_column(file_location fl);
+
+// Forget all the files registered by file_location_add_file,
+// freeing their line tables, so that file numbers start again from 0.
+// All file_locations made before become invalid.
+extern void file_location_release();
 
 #endif
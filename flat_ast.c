@@ -0,0 +1,285 @@
+#include <stdlib.h>
+#include <string.h>
+#include "flat_ast.h"
+#include "utilities.h"
+
+// Initial number of elements in each array of a flat AST
+#define INITIAL_FLAT_CAPACITY 64
+
+// Make room for n more elements at the end of the array *arr,
+// which has *num elements and room for *cap elements of size elem_size.
+// Return the index of the first of the n new elements.
+static flat_index flat_reserve(void **arr, uint32_t *num, uint32_t *cap,
+			       uint32_t n, size_t elem_size)
+{
+    if (*num + n > *cap) {
+	uint32_t new_cap = (*cap == 0) ? INITIAL_FLAT_CAPACITY : *cap;
+	while (*num + n > new_cap) {
+	    new_cap *= 2;
+	}
+	void *p = realloc(*arr, (size_t) new_cap * elem_size);
+	if (p == NULL) {
+	    bail_with_error("No space to grow a flat AST!");
+	}
+	*arr = p;
+	*cap = new_cap;
+    }
+    flat_index ret = *num;
+    *num += n;
+    return ret;
+}
+
+// Reserve n elements at the end of the array named arr in the flat AST fa
+#define FLAT_RESERVE(fa, arr, n)					\
+    flat_reserve((void **)&(fa)->arr, &(fa)->num_##arr,			\
+		 &(fa)->arr##_capacity, (n), sizeof(*(fa)->arr))
+
+static flat_index flatten_block(flat_ast_t *fa, const block_t *blk);
+
+// Add an ident with the given name and location to fa's idents
+static flat_index flatten_ident(flat_ast_t *fa, const char *name,
+				file_location floc)
+{
+    flat_index i = FLAT_RESERVE(fa, idents, 1);
+    fa->idents[i].file_loc = floc;
+    fa->idents[i].name = name;
+    fa->idents[i].lex_addr = lexical_address_unresolved();
+    return i;
+}
+
+// Add the expression exp (and its subexpressions) to fa's exprs
+static flat_index flatten_expr(flat_ast_t *fa, const expr_t *exp)
+{
+    flat_expr_t fe;
+    fe.file_loc = exp->file_loc;
+    fe.expr_kind = exp->expr_kind;
+    fe.op = NULL;
+    switch (exp->expr_kind) {
+    case expr_bin:
+	fe.op = exp->data.binary.arith_op.text;
+	fe.data.binary.expr1 = flatten_expr(fa, exp->data.binary.expr1);
+	fe.data.binary.expr2 = flatten_expr(fa, exp->data.binary.expr2);
+	break;
+    case expr_negated:
+	fe.data.negated = flatten_expr(fa, exp->data.negated.expr);
+	break;
+    case expr_ident:
+	fe.data.ident = flatten_ident(fa, exp->data.ident.name,
+				      exp->data.ident.file_loc);
+	break;
+    case expr_number:
+	fe.data.number = exp->data.number.value;
+	break;
+    default:
+	bail_with_error("Unexpected expr_kind_e (%d) in flatten_expr!",
+			exp->expr_kind);
+	break;
+    }
+    flat_index i = FLAT_RESERVE(fa, exprs, 1);
+    fa->exprs[i] = fe;
+    return i;
+}
+
+// Add the condition cond to fa's conditions
+static flat_index flatten_condition(flat_ast_t *fa, const condition_t *cond)
+{
+    flat_condition_t fc;
+    fc.cond_kind = cond->cond_kind;
+    if (cond->cond_kind == ck_db) {
+	fc.rel_op = NULL;
+	fc.expr1 = flatten_expr(fa, &cond->data.db_cond.dividend);
+	fc.expr2 = flatten_expr(fa, &cond->data.db_cond.divisor);
+    } else {
+	fc.rel_op = cond->data.rel_op_cond.rel_op.text;
+	fc.expr1 = flatten_expr(fa, &cond->data.rel_op_cond.expr1);
+	fc.expr2 = flatten_expr(fa, &cond->data.rel_op_cond.expr2);
+    }
+    flat_index i = FLAT_RESERVE(fa, conditions, 1);
+    fa->conditions[i] = fc;
+    return i;
+}
+
+static flat_range flatten_stmts(flat_ast_t *fa, const stmts_t *stmts);
+
+// Return the flat form of the statement s
+// (adding its parts, but not s itself, to fa)
+static flat_stmt_t flatten_stmt(flat_ast_t *fa, const stmt_t *s)
+{
+    flat_stmt_t fs;
+    fs.file_loc = s->file_loc;
+    fs.stmt_kind = s->stmt_kind;
+    switch (s->stmt_kind) {
+    case assign_stmt:
+	fs.data.assign_stmt.ident
+	    = flatten_ident(fa, s->data.assign_stmt.name,
+			    s->data.assign_stmt.file_loc);
+	fs.data.assign_stmt.expr = flatten_expr(fa, s->data.assign_stmt.expr);
+	break;
+    case call_stmt:
+	fs.data.call_stmt = flatten_ident(fa, s->data.call_stmt.name,
+					  s->data.call_stmt.file_loc);
+	break;
+    case if_stmt:
+	fs.data.if_stmt.condition
+	    = flatten_condition(fa, &s->data.if_stmt.condition);
+	fs.data.if_stmt.then_stmts
+	    = flatten_stmts(fa, s->data.if_stmt.then_stmts);
+	fs.data.if_stmt.has_else = (s->data.if_stmt.else_stmts != NULL);
+	if (fs.data.if_stmt.has_else) {
+	    fs.data.if_stmt.else_stmts
+		= flatten_stmts(fa, s->data.if_stmt.else_stmts);
+	} else {
+	    fs.data.if_stmt.else_stmts.first = 0;
+	    fs.data.if_stmt.else_stmts.count = 0;
+	}
+	break;
+    case while_stmt:
+	fs.data.while_stmt.condition
+	    = flatten_condition(fa, &s->data.while_stmt.condition);
+	fs.data.while_stmt.body = flatten_stmts(fa, s->data.while_stmt.body);
+	break;
+    case read_stmt:
+	fs.data.read_stmt = flatten_ident(fa, s->data.read_stmt.name,
+					  s->data.read_stmt.file_loc);
+	break;
+    case print_stmt:
+	fs.data.print_stmt = flatten_expr(fa, &s->data.print_stmt.expr);
+	break;
+    case block_stmt:
+	fs.data.block_stmt = flatten_block(fa, s->data.block_stmt.block);
+	break;
+    default:
+	bail_with_error("Unknown stmt_kind (%d) in flatten_stmt!",
+			s->stmt_kind);
+	break;
+    }
+    return fs;
+}
+
+// Add the statements in stmts to fa's stmts (consecutively)
+// and return their range
+static flat_range flatten_stmts(flat_ast_t *fa, const stmts_t *stmts)
+{
+    flat_range ret;
+    ret.first = 0;
+    ret.count = 0;
+    if (stmts->stmts_kind == empty_stmts_e) {
+	return ret;
+    }
+    ret.count = ast_list_length(stmts->stmt_list.start);
+    ret.first = FLAT_RESERVE(fa, stmts, ret.count);
+    flat_index i = ret.first;
+    for (const stmt_t *sp = stmts->stmt_list.start; sp != NULL; sp = sp->next) {
+	// fa->stmts may move while flattening sp, so assign afterwards
+	flat_stmt_t fs = flatten_stmt(fa, sp);
+	fa->stmts[i++] = fs;
+    }
+    return ret;
+}
+
+// Add the block blk (and everything in it) to fa's blocks
+static flat_index flatten_block(flat_ast_t *fa, const block_t *blk)
+{
+    flat_index bi = FLAT_RESERVE(fa, blocks, 1);
+    flat_block_t fb;
+    fb.file_loc = blk->file_loc;
+
+    // constant declarations
+    fb.const_decls.count = ast_list_length(blk->const_decls.start);
+    fb.const_decls.first = FLAT_RESERVE(fa, const_decls, fb.const_decls.count);
+    flat_index i = fb.const_decls.first;
+    for (const const_decl_t *cdp = blk->const_decls.start; cdp != NULL;
+	 cdp = cdp->next) {
+	flat_range defs;
+	defs.count = ast_list_length(cdp->const_def_list.start);
+	defs.first = FLAT_RESERVE(fa, const_defs, defs.count);
+	flat_index j = defs.first;
+	for (const const_def_t *dp = cdp->const_def_list.start; dp != NULL;
+	     dp = dp->next) {
+	    flat_index id = flatten_ident(fa, dp->ident.name,
+					  dp->ident.file_loc);
+	    fa->const_defs[j].ident = id;
+	    fa->const_defs[j].value = dp->number.value;
+	    j++;
+	}
+	fa->const_decls[i++] = defs;
+    }
+
+    // variable declarations
+    fb.var_decls.count = ast_list_length(blk->var_decls.var_decls);
+    fb.var_decls.first = FLAT_RESERVE(fa, var_decls, fb.var_decls.count);
+    i = fb.var_decls.first;
+    for (const var_decl_t *vdp = blk->var_decls.var_decls; vdp != NULL;
+	 vdp = vdp->next) {
+	flat_range ids;
+	ids.count = ast_list_length(vdp->ident_list.start);
+	ids.first = FLAT_RESERVE(fa, idents, ids.count);
+	flat_index j = ids.first;
+	for (const ident_t *ip = vdp->ident_list.start; ip != NULL;
+	     ip = ip->next) {
+	    fa->idents[j].file_loc = ip->file_loc;
+	    fa->idents[j].name = ip->name;
+	    fa->idents[j].lex_addr = lexical_address_unresolved();
+	    j++;
+	}
+	fa->var_decls[i++] = ids;
+    }
+
+    // procedure declarations
+    fb.proc_decls.count = ast_list_length(blk->proc_decls.proc_decls);
+    fb.proc_decls.first = FLAT_RESERVE(fa, proc_decls, fb.proc_decls.count);
+    i = fb.proc_decls.first;
+    for (const proc_decl_t *pdp = blk->proc_decls.proc_decls; pdp != NULL;
+	 pdp = pdp->next) {
+	flat_proc_decl_t fp;
+	fp.ident = flatten_ident(fa, pdp->name, pdp->file_loc);
+	fp.block = flatten_block(fa, pdp->block);
+	fa->proc_decls[i++] = fp;
+    }
+
+    fb.stmts = flatten_stmts(fa, &blk->stmts);
+    fa->blocks[bi] = fb;
+    return bi;
+}
+
+// Return a (pointer to a) fresh flat AST for the program prog.
+// If there is no space, bail with an error message,
+// so this never returns NULL.
+flat_ast_t *flat_ast_build(const block_t *prog)
+{
+    flat_ast_t *fa = (flat_ast_t *) calloc(1, sizeof(flat_ast_t));
+    if (fa == NULL) {
+	bail_with_error("No space to allocate a flat AST!");
+    }
+    fa->program = flatten_block(fa, prog);
+    return fa;
+}
+
+// Free all the storage of the flat AST fa (including fa itself)
+void flat_ast_free(flat_ast_t *fa)
+{
+    free(fa->blocks);
+    free(fa->const_decls);
+    free(fa->const_defs);
+    free(fa->var_decls);
+    free(fa->idents);
+    free(fa->proc_decls);
+    free(fa->stmts);
+    free(fa->conditions);
+    free(fa->exprs);
+    free(fa);
+}
+
+// Return the number of bytes used by the nodes of fa
+size_t flat_ast_bytes(const flat_ast_t *fa)
+{
+    return fa->num_blocks * sizeof(flat_block_t)
+	+ fa->num_const_decls * sizeof(flat_range)
+	+ fa->num_const_defs * sizeof(flat_const_def_t)
+	+ fa->num_var_decls * sizeof(flat_range)
+	+ fa->num_idents * sizeof(flat_ident_t)
+	+ fa->num_proc_decls * sizeof(flat_proc_decl_t)
+	+ fa->num_stmts * sizeof(flat_stmt_t)
+	+ fa->num_conditions * sizeof(flat_condition_t)
+	+ fa->num_exprs * sizeof(flat_expr_t);
+}
@@ -0,0 +1,141 @@
+#ifndef _FLAT_AST_H
+#define _FLAT_AST_H
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "ast.h"
+
+// A flat AST stores the nodes of a program in contiguous arrays,
+// one array per kind of node, and nodes refer to each other
+// by 32-bit indexes into those arrays instead of by pointers.
+// The elements of each list are consecutive in their array,
+// so a list is just a range (first, count).
+// Names and operator spellings are interned (see intern.h)
+// and nothing points into the arena,
+// so a flat AST stays valid after arena_release.
+
+// an index into one of the arrays of a flat AST
+typedef uint32_t flat_index;
+
+// count consecutive elements of an array, starting at first
+typedef struct {
+    flat_index first;
+    uint32_t count;
+} flat_range;
+
+// ident ::= name (in idents)
+typedef struct {
+    file_location file_loc;
+    const char *name;
+    lexical_address lex_addr; // of a use, set by scope checking
+} flat_ident_t;
+
+// const-def ::= ident = number (in const_defs)
+typedef struct {
+    flat_index ident;
+    word_type value;
+} flat_const_def_t;
+
+// proc-decl ::= proc ident block (in proc_decls)
+typedef struct {
+    flat_index ident;
+    flat_index block;
+} flat_proc_decl_t;
+
+// block ::= begin const-decls var-decls proc-decls stmts end (in blocks)
+// Each element of const_decls is a range of const_defs,
+// and each element of var_decls is a range of idents.
+typedef struct {
+    file_location file_loc;
+    flat_range const_decls; // of const_decls
+    flat_range var_decls;   // of var_decls
+    flat_range proc_decls;  // of proc_decls
+    flat_range stmts;       // of stmts (count == 0 for empty stmts)
+} flat_block_t;
+
+// expressions (in exprs)
+typedef struct {
+    file_location file_loc;
+    expr_kind_e expr_kind;
+    const char *op; // spelling of the operator, for expr_bin
+    union {
+	struct {
+	    flat_index expr1;
+	    flat_index expr2;
+	} binary;      // indexes of exprs
+	flat_index negated; // index of an expr
+	flat_index ident;   // index of an ident
+	word_type number;
+    } data;
+} flat_expr_t;
+
+// conditions (in conditions)
+// For ck_db, expr1 is the dividend and expr2 the divisor.
+typedef struct {
+    condition_kind_e cond_kind;
+    const char *rel_op; // spelling of the relational operator, for ck_rel
+    flat_index expr1;
+    flat_index expr2;
+} flat_condition_t;
+
+// statements (in stmts)
+typedef struct {
+    file_location file_loc;
+    stmt_kind_e stmt_kind;
+    union {
+	struct {
+	    flat_index ident;
+	    flat_index expr;
+	} assign_stmt;
+	flat_index call_stmt;  // index of an ident
+	struct {
+	    flat_index condition;
+	    flat_range then_stmts;
+	    flat_range else_stmts;
+	    bool has_else;
+	} if_stmt;
+	struct {
+	    flat_index condition;
+	    flat_range body;
+	} while_stmt;
+	flat_index read_stmt;  // index of an ident
+	flat_index print_stmt; // index of an expr
+	flat_index block_stmt; // index of a block
+    } data;
+} flat_stmt_t;
+
+// A whole program, with one growable array for each kind of node
+typedef struct {
+    flat_index program; // index of the program's block
+    flat_block_t *blocks;
+    uint32_t num_blocks, blocks_capacity;
+    flat_range *const_decls;
+    uint32_t num_const_decls, const_decls_capacity;
+    flat_const_def_t *const_defs;
+    uint32_t num_const_defs, const_defs_capacity;
+    flat_range *var_decls;
+    uint32_t num_var_decls, var_decls_capacity;
+    flat_ident_t *idents;
+    uint32_t num_idents, idents_capacity;
+    flat_proc_decl_t *proc_decls;
+    uint32_t num_proc_decls, proc_decls_capacity;
+    flat_stmt_t *stmts;
+    uint32_t num_stmts, stmts_capacity;
+    flat_condition_t *conditions;
+    uint32_t num_conditions, conditions_capacity;
+    flat_expr_t *exprs;
+    uint32_t num_exprs, exprs_capacity;
+} flat_ast_t;
+
+// Return a (pointer to a) fresh flat AST for the program prog.
+// If there is no space, bail with an error message,
+// so this never returns NULL.
+extern flat_ast_t *flat_ast_build(const block_t *prog);
+
+// Free all the storage of the flat AST fa (including fa itself)
+extern void flat_ast_free(flat_ast_t *fa);
+
+// Return the number of bytes used by the nodes of fa
+extern size_t flat_ast_bytes(const flat_ast_t *fa);
+
+#endif
@@ -0,0 +1,514 @@
+/* A hand-written lexical analyzer for SPL */
+
+// This scanner is an alternative to the one generated by flex
+// from spl_lexer.l, with the same interface (see lexer.h)
+// and the same tokens, values, and error messages.
+// It reads the whole input file into a buffer, classifies characters
+// with a table, and recognizes keywords with a perfect hash.
+// Numbers are converted as in the flex scanner (see number_literal.h).
+// Long runs of spaces and of identifier characters are skipped
+// many characters at a time (see simd_scan.h),
+// and comments are skipped with memchr (which the C library vectorizes).
+// The only storage used for each token is the arena copy
+// of a number's text (as in the flex scanner).
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <limits.h>
+#include <assert.h>
+#include "ast.h"
+#include "parser_types.h"
+#include "utilities.h"
+#include "lexer.h"
+#include "intern.h"
+#include "arena.h"
+#include "stats.h"
+#include "number_literal.h"
+#include "simd_scan.h"
+
+/* Tokens generated by Bison */
+#include "spl.tab.h"
+
+// Number of bytes read from the input file at a time
+#define READ_CHUNK (64 * 1024)
+
+// Number of null characters kept after the end of the input
+// (so that scanning loops can look past the end safely)
+#define INPUT_PADDING 64
+_Static_assert(INPUT_PADDING >= SIMD_SCAN_PADDING,
+	       "the input is not padded enough for simd_scan");
+
+// Number of characters of a run of spaces or identifier characters
+// looked at one at a time before the rest is skipped with simd_scan
+// (most runs are shorter, and for them that is faster)
+#define SHORT_RUN 8
+
+// Classes of characters
+typedef enum {
+    cc_invalid,  // not allowed in SPL (or the null after the input)
+    cc_space,    // [ \t\v\f\r], which are ignored
+    cc_newline,
+    cc_letter,
+    cc_digit,
+    cc_percent,  // starts a comment
+    cc_punct     // starts an operator or punctuation token
+} char_class;
+
+// The class of each character (cc_invalid unless set below)
+static unsigned char char_classes[UCHAR_MAX + 1];
+
+// The keywords and their tokens, in slots given by keyword_hash
+#define KEYWORD_SLOTS 32
+typedef struct {
+    const char *text;
+    size_t len;
+    int code;
+} keyword_t;
+static keyword_t keywords[KEYWORD_SLOTS];
+
+// The interned spelling of each token that has a fixed spelling
+// (indexed by token code minus TOKEN_TEXT_BASE)
+#define TOKEN_TEXT_BASE identsym
+static const char *token_texts[geqsym - TOKEN_TEXT_BASE + 1];
+
+// Have the lexer's tables been set up yet?
+static bool tables_initialized = false;
+
+/* The filename of the file being read */
+static char *input_filename;
+
+/* Have any errors been noted? */
+static bool errors_noted;
+
+/* The number of the input file in the table of file locations */
+static unsigned int input_file_id;
+
+// The input, followed by INPUT_PADDING null characters,
+// and the space allocated for it
+static char *input = NULL;
+static size_t input_length = 0;
+static size_t input_capacity = 0;
+
+// The position of the next character to scan
+// and of the start of the token most recently scanned
+static const char *cur = NULL;
+static const char *token_start = NULL;
+
+// The line number of the next character
+static unsigned int line = 1;
+
+// Has the end of the input been reached?
+static bool at_eof = true;
+
+// Return the slot in keywords for an identifier
+// that starts with first and ends with last.
+// This is a perfect hash for the keywords of SPL.
+static inline unsigned int keyword_hash(unsigned char first,
+					unsigned char last)
+{
+    return (first * 12u + last) % KEYWORD_SLOTS;
+}
+
+// Add the keyword text with token code to the keywords table
+static void add_keyword(const char *text, int code)
+{
+    size_t len = strlen(text);
+    unsigned int h = keyword_hash(text[0], text[len-1]);
+    assert(keywords[h].text == NULL);
+    keywords[h].text = text;
+    keywords[h].len = len;
+    keywords[h].code = code;
+    token_texts[code - TOKEN_TEXT_BASE] = intern_string(text);
+}
+
+// Record the (interned) spelling of the token with code
+static void add_token_text(const char *text, int code)
+{
+    token_texts[code - TOKEN_TEXT_BASE] = intern_string(text);
+}
+
+// Set up the character class, keyword, and token text tables
+static void lexer_init_tables()
+{
+    for (int c = 'a'; c <= 'z'; c++) {
+	char_classes[c] = cc_letter;
+	char_classes[c - 'a' + 'A'] = cc_letter;
+    }
+    for (int c = '0'; c <= '9'; c++) {
+	char_classes[c] = cc_digit;
+    }
+    char_classes[' '] = char_classes['\t'] = char_classes['\v']
+	= char_classes['\f'] = char_classes['\r'] = cc_space;
+    char_classes['\n'] = cc_newline;
+    char_classes['%'] = cc_percent;
+    const char *puncts = "+-*/.;,:=!<>()";
+    for (const char *p = puncts; *p != '\0'; p++) {
+	char_classes[(unsigned char) *p] = cc_punct;
+    }
+
+    add_keyword("const", constsym);
+    add_keyword("var", varsym);
+    add_keyword("proc", procsym);
+    add_keyword("call", callsym);
+    add_keyword("begin", beginsym);
+    add_keyword("end", endsym);
+    add_keyword("if", ifsym);
+    add_keyword("then", thensym);
+    add_keyword("else", elsesym);
+    add_keyword("while", whilesym);
+    add_keyword("do", dosym);
+    add_keyword("read", readsym);
+    add_keyword("print", printsym);
+    add_keyword("divisible", divisiblesym);
+    add_keyword("by", bysym);
+
+    add_token_text("+", plussym);
+    add_token_text("-", minussym);
+    add_token_text("*", multsym);
+    add_token_text("/", divsym);
+    add_token_text("=", eqsym);
+    add_token_text("==", eqeqsym);
+    add_token_text("!=", neqsym);
+    add_token_text("<", ltsym);
+    add_token_text("<=", leqsym);
+    add_token_text(">", gtsym);
+    add_token_text(">=", geqsym);
+    add_token_text("(", lparensym);
+    add_token_text(")", rparensym);
+    simd_scan_init();
+    tables_initialized = true;
+}
+
+// Read all of the file named fname into input
+static void lexer_read_file(const char *fname)
+{
+    FILE *f = fopen(fname, "r");
+    if (f == NULL) {
+	bail_with_error("Cannot open %s", fname);
+    }
+    input_length = 0;
+    for (;;) {
+	if (input_capacity < input_length + READ_CHUNK + INPUT_PADDING) {
+	    input_capacity = 2 * input_capacity + READ_CHUNK + INPUT_PADDING;
+	    input = (char *) realloc(input, input_capacity);
+	    if (input == NULL) {
+		bail_with_error("No space to read %s!", fname);
+	    }
+	}
+	size_t got = fread(input + input_length, 1, READ_CHUNK, f);
+	input_length += got;
+	if (got < READ_CHUNK) {
+	    break;
+	}
+    }
+    if (ferror(f)) {
+	bail_with_error("Cannot read %s", fname);
+    }
+    fclose(f);
+    memset(input + input_length, '\0', INPUT_PADDING);
+}
+
+// Requires: fname != NULL
+// Requires: fname is the name of a readable file
+// Initialize the lexer and start it reading
+// from the given file name
+// (the whole file is read into memory at once).
+// This may be called again for another file,
+// even if the previous file was not read to its end.
+void lexer_init(char *fname)
+{
+    if (!tables_initialized) {
+	lexer_init_tables();
+    }
+    errors_noted = false;
+    input_filename = fname;
+    input_file_id = file_location_add_file(fname);
+    lexer_read_file(fname);
+    cur = input;
+    token_start = input;
+    line = 1;
+    at_eof = false;
+}
+
+// Return the offset in the input of the character at p
+static inline unsigned int offset_of(const char *p)
+{
+    return (unsigned int) (p - input);
+}
+
+// set the lexer's value for a token in yylval as an AST
+static void tok2ast(int code)
+{
+    AST t;
+    t.token.file_loc = lexer_location();
+    t.token.type_tag = token_ast;
+    t.token.code = code;
+    t.token.text = token_texts[code - TOKEN_TEXT_BASE];
+    yylval = t;
+}
+
+static void ident2ast(const char *name, size_t len)
+{
+    AST t;
+    assert(input_filename != NULL);
+    // (ast_ident also marks the name's lexical address as unresolved)
+    t.ident = ast_ident(lexer_location(), intern_string_n(name, len));
+    yylval = t;
+}
+
+static void number2ast(const char *text, word_type val)
+{
+    AST t;
+    t.number.file_loc = lexer_location();
+    t.number.type_tag = number_ast;
+    t.number.text = text;
+    t.number.value = val;
+    yylval = t;
+}
+
+// Scan the number starting at cur, and return its token
+static int lexer_scan_number()
+{
+    do {
+	cur++;
+    } while (char_classes[(unsigned char) *cur] == cc_digit);
+    size_t len = (size_t) (cur - token_start);
+    char *text = arena_strndup(token_start, len);
+    number2ast(text, number_literal_value(text, len));
+    return numbersym;
+}
+
+// Scan the identifier or keyword starting at cur, and return its token
+static int lexer_scan_word()
+{
+    const char *short_end = token_start + SHORT_RUN;
+    cur++;
+    while (cur < short_end
+	   && (char_classes[(unsigned char) *cur] == cc_letter
+	       || char_classes[(unsigned char) *cur] == cc_digit)) {
+	cur++;
+    }
+    if (cur == short_end) {
+	cur = simd_skip_ident_chars(cur);
+    }
+    size_t len = (size_t) (cur - token_start);
+    const keyword_t *kw = &keywords[keyword_hash(token_start[0],
+						 token_start[len-1])];
+    if (kw->len == len && memcmp(kw->text, token_start, len) == 0) {
+	tok2ast(kw->code);
+	return kw->code;
+    }
+    ident2ast(token_start, len);
+    return identsym;
+}
+
+// Report the invalid character at token_start
+static void lexer_invalid_char()
+{
+    char msgbuf[512];
+    sprintf(msgbuf, "invalid character: '%c' ('\\0%o')",
+	    *token_start, *token_start);
+    yyerror(lexer_filename(), msgbuf);
+}
+
+// Scan the operator or punctuation token starting at cur,
+// and return its token (or 0 if it is an invalid character)
+static int lexer_scan_punct()
+{
+    char c = *cur++;
+    char next = *cur;
+    switch (c) {
+    case '+': tok2ast(plussym); return plussym;
+    case '-': tok2ast(minussym); return minussym;
+    case '*': tok2ast(multsym); return multsym;
+    case '/': tok2ast(divsym); return divsym;
+    case '.': return periodsym;
+    case ';': return semisym;
+    case ',': return commasym;
+    case '(': tok2ast(lparensym); return lparensym;
+    case ')': tok2ast(rparensym); return rparensym;
+    case ':':
+	if (next == '=') {
+	    cur++;
+	    return becomessym;
+	}
+	break;
+    case '=':
+	if (next == '=') {
+	    cur++;
+	    // as in the flex scanner, the token's code is eqsym
+	    tok2ast(eqeqsym);
+	    yylval.token.code = eqsym;
+	    return eqeqsym;
+	}
+	tok2ast(eqsym);
+	return eqsym;
+    case '!':
+	if (next == '=') {
+	    cur++;
+	    tok2ast(neqsym);
+	    return neqsym;
+	}
+	break;
+    case '<':
+	if (next == '=') {
+	    cur++;
+	    tok2ast(leqsym);
+	    return leqsym;
+	}
+	tok2ast(ltsym);
+	return ltsym;
+    case '>':
+	if (next == '=') {
+	    cur++;
+	    tok2ast(geqsym);
+	    return geqsym;
+	}
+	tok2ast(gtsym);
+	return gtsym;
+    }
+    lexer_invalid_char();
+    return 0;
+}
+
+// Return the next token in the input (0 at the end)
+static int lexer_scan()
+{
+    if (at_eof) {
+	return YYEOF;
+    }
+    for (;;) {
+	token_start = cur;
+	switch (char_classes[(unsigned char) *cur]) {
+	case cc_space:
+	    cur++;
+	    while (cur < token_start + SHORT_RUN
+		   && char_classes[(unsigned char) *cur] == cc_space) {
+		cur++;
+	    }
+	    if (cur == token_start + SHORT_RUN) {
+		cur = simd_skip_spaces(cur);
+	    }
+	    break;
+	case cc_newline:
+	    cur++;
+	    line++;
+	    file_location_note_line_start(input_file_id, offset_of(cur));
+	    break;
+	case cc_percent:
+	    {
+		// skip the comment, up to (not including) the newline
+		const char *end = input + input_length;
+		const char *nl = memchr(cur, '\n', (size_t) (end - cur));
+		cur = (nl == NULL) ? end : nl;
+	    }
+	    break;
+	case cc_digit:
+	    return lexer_scan_number();
+	case cc_letter:
+	    return lexer_scan_word();
+	case cc_punct:
+	    {
+		int t = lexer_scan_punct();
+		if (t != 0) {
+		    return t;
+		}
+	    }
+	    break;
+	default:
+	    if (cur == input + input_length) {
+		// as yywrap does for the flex scanner
+		at_eof = true;
+		input_filename = NULL;
+		return YYEOF;
+	    }
+	    cur++;
+	    lexer_invalid_char();
+	    break;
+	}
+    }
+}
+
+// Return the next token in the input (0 at the end),
+// counting it (and timing the scanner) for the statistics
+int yylex(YYSTYPE *yylval_param)
+{
+    stats_phase_start(stats_lex);
+    int t = lexer_scan();
+    stats_phase_end(stats_lex);
+    if (t != 0) {
+	stats_count_token();
+    }
+    return t;
+}
+
+// Return the name of the current input file
+const char *lexer_filename()
+{
+    return input_filename;
+}
+
+// Return the line number of the next token
+unsigned int lexer_line()
+{
+    return line;
+}
+
+// Return the location of the start of the token most recently read
+file_location lexer_location()
+{
+    return file_location_make(input_file_id, offset_of(token_start));
+}
+
+/* Report an error to the user on stderr */
+void yyerror(const char *filename, const char *msg)
+{
+    fflush(stdout);
+    fprintf(stderr, "%s:%d: %s\n", input_filename, lexer_line(), msg);
+    errors_noted = true;
+}
+
+// On standard output:
+// Print a message about the file name of the lexer's input
+// and then print a heading for the lexer's output.
+void lexer_print_output_header()
+{
+    printf("Tokens from file %s\n", lexer_filename());
+    printf("%-6s %-4s  %s\n", "Number", "Line", "Text");
+}
+
+// Have any errors been noted by the lexer?
+bool lexer_has_errors()
+{
+    return errors_noted;
+}
+
+// Print information about the token t to stdout
+// followed by a newline
+void lexer_print_token(int t, unsigned int tline, const char *txt)
+{
+    printf("%-6d %-4d \"%s\"\n", t, tline, txt);
+}
+
+/* Read all the tokens from the input file
+ * and print each token on standard output
+ * using the format in lexer_print_token */
+void lexer_output()
+{
+    lexer_print_output_header();
+    AST dummy;
+    int t;
+    do {
+	t = yylex(&dummy);
+	if (t == YYEOF) {
+	    break;
+	}
+	// print the token's text from the input, null-terminated for now
+	char *end = input + offset_of(cur);
+	char saved = *end;
+	*end = '\0';
+	lexer_print_token(t, line, token_start);
+	*end = saved;
+    } while (t != YYEOF);
+}
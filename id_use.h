@@ -2,8 +2,7 @@
 #ifndef _ID_USE_H
 #define _ID_USE_H
 #include "id_attrs.h"
-// we'll use lexical_address in HW4
-// #include "lexical_address.h"
+#include "lexical_address.h"
 
 // An id_use struct gives all the information from
 // a lookup in the symbol table for a name:
@@ -15,13 +14,14 @@ typedef struct {
     unsigned int levelsOutward;    
 } id_use;
 
-// Requires: attrs != NULL
-// Return a (pointer to a fresh) id_use struct containing the attributes
+// Return an id_use struct containing the attributes
 // given by attrs and the information about the number of lexical levels
 // outward from the current scope where the declaration was found.
-extern id_use *id_use_create(id_attrs *attrs, unsigned int levelsOut);
+// (An id_use with attrs == NULL means that the name was not declared.)
+// The id_use is returned by value, so nothing is allocated.
+extern id_use id_use_create(id_attrs *attrs, unsigned int levelsOut);
 
-// Requires: idu != NULL
-// Return (a pointer to) the lexical address for idu.
-// extern lexical_address *id_use_2_lexical_address(id_use *idu);
+// Requires: idu.attrs != NULL
+// Return the lexical address for idu.
+extern lexical_address id_use_2_lexical_address(id_use idu);
 #endif
@@ -0,0 +1,129 @@
+#include <stdlib.h>
+#include <string.h>
+#include "intern.h"
+#include "utilities.h"
+
+// Interned strings are copied into large blocks of characters,
+// so each distinct name costs no separate malloc.
+#define INTERN_BLOCK_SIZE 65536
+
+// Initial number of slots in the hash table (a power of 2)
+#define INITIAL_TABLE_CAPACITY 1024
+
+typedef struct {
+    const char *str; // NULL if the slot is empty
+    size_t len;
+    unsigned int hash;
+} intern_slot_t;
+
+// the hash table, with load factor kept at most 1/2
+static intern_slot_t *table = NULL;
+static unsigned int table_capacity = 0;
+static unsigned int table_count = 0;
+
+// the block currently being filled with characters
+static char *block = NULL;
+static size_t block_used = 0;
+static size_t block_size = 0;
+
+// Return a hash code for the first len characters of s (FNV-1a)
+static unsigned int intern_hash(const char *s, size_t len)
+{
+    unsigned int h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+	h ^= (unsigned char)s[i];
+	h *= 16777619u;
+    }
+    return h;
+}
+
+// Return a fresh, permanent, null-terminated copy of s[0..len)
+static const char *intern_copy(const char *s, size_t len)
+{
+    if (block == NULL || block_used + len + 1 > block_size) {
+	size_t sz = MAX(INTERN_BLOCK_SIZE, len + 1);
+	block = (char *) malloc(sz);
+	if (block == NULL) {
+	    bail_with_error("No space to intern a string!");
+	}
+	block_used = 0;
+	block_size = sz;
+    }
+    char *ret = block + block_used;
+    memcpy(ret, s, len);
+    ret[len] = '\0';
+    block_used += len + 1;
+    return ret;
+}
+
+// Requires: there is an empty slot in table
+// Put the slot sl into the table
+static void intern_put(intern_slot_t sl)
+{
+    unsigned int mask = table_capacity - 1;
+    unsigned int i = sl.hash & mask;
+    while (table[i].str != NULL) {
+	i = (i + 1) & mask;
+    }
+    table[i] = sl;
+}
+
+// Make sure the table has room for one more string
+static void intern_reserve()
+{
+    if (table != NULL && 2 * (table_count + 1) <= table_capacity) {
+	return;
+    }
+    intern_slot_t *old_table = table;
+    unsigned int old_cap = table_capacity;
+    table_capacity = (table == NULL) ? INITIAL_TABLE_CAPACITY
+	                             : 2 * table_capacity;
+    table = (intern_slot_t *) calloc(table_capacity, sizeof(intern_slot_t));
+    if (table == NULL) {
+	bail_with_error("No space for the interning table!");
+    }
+    for (unsigned int i = 0; i < old_cap; i++) {
+	if (old_table[i].str != NULL) {
+	    intern_put(old_table[i]);
+	}
+    }
+    free(old_table);
+}
+
+// Requires: s != NULL and s points to at least len characters
+// Return the canonical copy of the first len characters of s,
+// (which need not be null-terminated), as in intern_string.
+const char *intern_string_n(const char *s, size_t len)
+{
+    intern_reserve();
+    unsigned int hash = intern_hash(s, len);
+    unsigned int mask = table_capacity - 1;
+    unsigned int i = hash & mask;
+    while (table[i].str != NULL) {
+	if (table[i].hash == hash && table[i].len == len
+	    && memcmp(table[i].str, s, len) == 0) {
+	    return table[i].str;
+	}
+	i = (i + 1) & mask;
+    }
+    table[i].str = intern_copy(s, len);
+    table[i].len = len;
+    table[i].hash = hash;
+    table_count++;
+    return table[i].str;
+}
+
+// Requires: s != NULL
+// Return the canonical (interned) copy of the string s,
+// adding a copy of s to the table if it is not already there.
+// Two calls with equal strings return the same pointer.
+const char *intern_string(const char *s)
+{
+    return intern_string_n(s, strlen(s));
+}
+
+// Return the number of distinct strings that have been interned
+unsigned int intern_count()
+{
+    return table_count;
+}
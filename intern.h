@@ -0,0 +1,24 @@
+#ifndef _INTERN_H
+#define _INTERN_H
+
+#include <stddef.h>
+
+// The interning table keeps exactly one copy of each distinct
+// identifier text, so that names can be compared by pointer.
+// Interned strings are never freed and are never modified.
+
+// Requires: s != NULL
+// Return the canonical (interned) copy of the string s,
+// adding a copy of s to the table if it is not already there.
+// Two calls with equal strings return the same pointer.
+extern const char *intern_string(const char *s);
+
+// Requires: s != NULL and s points to at least len characters
+// Return the canonical copy of the first len characters of s,
+// (which need not be null-terminated), as in intern_string.
+extern const char *intern_string_n(const char *s, size_t len);
+
+// Return the number of distinct strings that have been interned
+extern unsigned int intern_count();
+
+#endif
@@ -2,11 +2,13 @@
 #ifndef _LEXER_H
 #define _LEXER_H
 #include <stdbool.h>
+#include "file_location.h"
 
 // Requires: fname != NULL
 // Requires: fname is the name of a readable file
 // Initialize the lexer and start it reading
 // from the given file name
+// (this may be called again to start on another file)
 extern void lexer_init(char *fname);
 
 // Return the next token in the input
@@ -18,6 +20,9 @@ extern const char *lexer_filename();
 // Return the line number of the next token
 extern unsigned int lexer_line();
 
+// Return the location of the start of the token most recently read
+extern file_location lexer_location();
+
 // On standard output:
 // Print a message about the file name of the lexer's input
 // and then print a heading for the lexer's output.
@@ -0,0 +1,191 @@
+#define _POSIX_C_SOURCE 200809L  // for clock_gettime
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <sys/stat.h>
+#include "lexer.h"
+#include "utilities.h"
+#include "arena.h"
+#include "file_location.h"
+#include "spl.tab.h"
+
+// The lexer has three modes:
+//  - by default, it prints the tokens of one file (see lexer_output),
+//  - with --bench, it reads all the tokens of each file
+//    (repeatedly, with --repeat) without printing them,
+//    and then reports the speed of the lexer,
+//  - with --dump, it writes the tokens of each file to a binary file.
+//
+// The binary token dump starts with the 8 bytes of TOKEN_DUMP_MAGIC.
+// Then, for each file, it has the length of the file's name (a varint),
+// the file's name, the file's tokens, and a 0 byte.
+// Each token is a byte holding the token's code minus TOKEN_CODE_BASE,
+// then the token's line number minus that of the previous token
+// (a varint, starting from line 1 for each file),
+// and then, for identifiers and numbers only, the length of the
+// token's text (a varint) and that text.
+// A varint holds 7 bits of a number per byte, least significant first,
+// with the high bit set in all but the last byte.
+
+// The first bytes of a binary token dump
+#define TOKEN_DUMP_MAGIC "SPLTOK1\n"
+
+// Subtracted from each token's code in a token dump
+// (the tokens made by bison start after this)
+#define TOKEN_CODE_BASE 256
+
+// Did the lexer note errors in any file?
+// (lexer_has_errors only tells about the current file)
+static bool errors_seen = false;
+
+/* Print a usage message on stderr
+   and exit with failure. */
+static void usage(const char *cmdname)
+{
+    fprintf(stderr,
+	    "Usage: %s file.spl\n"
+	    "       %s --bench [--repeat N] file.spl...\n"
+	    "       %s --dump outfile file.spl...\n",
+	    cmdname, cmdname, cmdname);
+    exit(EXIT_FAILURE);
+}
+
+// Return the number of seconds from start to end
+static double seconds_between(const struct timespec *start,
+			      const struct timespec *end)
+{
+    return (double) (end->tv_sec - start->tv_sec)
+	+ (double) (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Read all the tokens of each of the num_files files named in fnames,
+// repeat times over, and print how fast that was on stdout
+static void bench_lexer(char **fnames, int num_files, unsigned int repeat)
+{
+    unsigned long num_tokens = 0;
+    unsigned long num_bytes = 0;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned int r = 0; r < repeat; r++) {
+	for (int i = 0; i < num_files; i++) {
+	    struct stat sb;
+	    if (stat(fnames[i], &sb) != 0) {
+		bail_with_error("Cannot find the size of %s", fnames[i]);
+	    }
+	    num_bytes += (unsigned long) sb.st_size;
+	    lexer_init(fnames[i]);
+	    YYSTYPE lval;
+	    while (yylex(&lval) != YYEOF) {
+		num_tokens++;
+	    }
+	    errors_seen |= lexer_has_errors();
+	    // the tokens are not needed
+	    arena_release();
+	    file_location_release();
+	}
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double secs = seconds_between(&start, &end);
+    printf("%lu tokens, %lu bytes in %.6f s\n", num_tokens, num_bytes, secs);
+    if (secs > 0) {
+	printf("%.0f tokens/s, %.2f MB/s\n", num_tokens / secs,
+	       num_bytes / secs / 1e6);
+    }
+}
+
+// Write n to out as a varint
+static void write_varint(FILE *out, unsigned long n)
+{
+    while (n >= 0x80) {
+	putc((int) ((n & 0x7f) | 0x80), out);
+	n >>= 7;
+    }
+    putc((int) n, out);
+}
+
+// Write the len characters of s to out, preceded by len as a varint
+static void write_text(FILE *out, const char *s, size_t len)
+{
+    write_varint(out, len);
+    fwrite(s, 1, len, out);
+}
+
+// Write the tokens of each of the num_files files named in fnames
+// to the file named outname, as a binary token dump
+static void dump_tokens(const char *outname, char **fnames, int num_files)
+{
+    FILE *out = fopen(outname, "wb");
+    if (out == NULL) {
+	bail_with_error("Cannot open %s", outname);
+    }
+    fputs(TOKEN_DUMP_MAGIC, out);
+    for (int i = 0; i < num_files; i++) {
+	write_text(out, fnames[i], strlen(fnames[i]));
+	lexer_init(fnames[i]);
+	unsigned int prev_line = 1;
+	YYSTYPE lval;
+	int t;
+	// the lexer puts the value of each token in yylval
+	while ((t = yylex(&lval)) != YYEOF) {
+	    unsigned int line = lexer_line();
+	    putc(t - TOKEN_CODE_BASE, out);
+	    write_varint(out, line - prev_line);
+	    prev_line = line;
+	    if (t == identsym) {
+		write_text(out, yylval.ident.name, strlen(yylval.ident.name));
+	    } else if (t == numbersym) {
+		write_text(out, yylval.number.text, strlen(yylval.number.text));
+	    }
+	}
+	putc(0, out);
+	errors_seen |= lexer_has_errors();
+	arena_release();
+	file_location_release();
+    }
+    if (fclose(out) == EOF) {
+	bail_with_error("Cannot write %s", outname);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const char *cmdname = argv[0];
+    bool bench = false;
+    unsigned int repeat = 1;
+    const char *dump_name = NULL;
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-'; i++) {
+	if (strcmp(argv[i], "--bench") == 0) {
+	    bench = true;
+	} else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+	    char *end;
+	    long n = strtol(argv[++i], &end, 10);
+	    if (*end != '\0' || n < 1) {
+		usage(cmdname);
+	    }
+	    repeat = (unsigned int) n;
+	} else if (strcmp(argv[i], "--dump") == 0 && i + 1 < argc) {
+	    dump_name = argv[++i];
+	} else {
+	    usage(cmdname);
+	}
+    }
+    int num_files = argc - i;
+    if (num_files < 1 || (bench && dump_name != NULL) || (!bench && repeat != 1)
+	|| (!bench && dump_name == NULL && num_files != 1)) {
+	usage(cmdname);
+    }
+
+    if (bench) {
+	bench_lexer(argv + i, num_files, repeat);
+    } else if (dump_name != NULL) {
+	dump_tokens(dump_name, argv + i, num_files);
+    } else {
+	lexer_init(argv[i]);
+	lexer_output();
+	errors_seen = lexer_has_errors();
+    }
+    return errors_seen ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,27 @@
+#include <limits.h>
+#include "lexical_address.h"
+
+// levelsOutward of a lexical address that has not been resolved
+#define UNRESOLVED_LEVELS UINT_MAX
+
+// Return a lexical address with the given fields
+lexical_address lexical_address_create(unsigned int levelsOut,
+				       unsigned int ofst_cnt)
+{
+    lexical_address ret;
+    ret.levelsOutward = levelsOut;
+    ret.offset_count = ofst_cnt;
+    return ret;
+}
+
+// Return a lexical address for a use that has not been resolved
+lexical_address lexical_address_unresolved()
+{
+    return lexical_address_create(UNRESOLVED_LEVELS, 0);
+}
+
+// Has la been resolved to a declaration?
+bool lexical_address_is_resolved(lexical_address la)
+{
+    return la.levelsOutward != UNRESOLVED_LEVELS;
+}
@@ -0,0 +1,26 @@
+#ifndef _LEXICAL_ADDRESS_H
+#define _LEXICAL_ADDRESS_H
+#include <stdbool.h>
+
+// A lexical address says where the declaration used by a name is:
+// levelsOutward is the number of scopes out from the use
+// to the scope of the declaration,
+// and offset_count is the declaration's offset_count (see id_attrs.h).
+typedef struct {
+    unsigned int levelsOutward;
+    unsigned int offset_count;
+} lexical_address;
+
+// Return a lexical address with the given fields
+extern lexical_address lexical_address_create(unsigned int levelsOut,
+					      unsigned int ofst_cnt);
+
+// Return a lexical address for a use that has not been resolved
+// (e.g., because scope checking has not been done yet,
+// or the name was not declared)
+extern lexical_address lexical_address_unresolved();
+
+// Has la been resolved to a declaration?
+extern bool lexical_address_is_resolved(lexical_address la);
+
+#endif
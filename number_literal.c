@@ -0,0 +1,40 @@
+#include <stdio.h>
+#include <limits.h>
+#include "number_literal.h"
+#include "utilities.h"
+#include "lexer.h"
+
+// Longest number text shown in full in the message about a large number
+#define MAX_SHOWN_DIGITS 300
+
+// Return the value of the len decimal digits starting at text,
+// saturating at ULONG_MAX as sscanf's "%lu" does
+static unsigned long accumulate_digits(const char *text, size_t len)
+{
+    unsigned long val = 0;
+    for (size_t i = 0; i < len; i++) {
+	unsigned int d = (unsigned int) (text[i] - '0');
+	if (val > (ULONG_MAX - d) / 10) {
+	    // the rest of the digits cannot make it smaller
+	    return ULONG_MAX;
+	}
+	val = val * 10 + d;
+    }
+    return val;
+}
+
+// Return the value of the number written as text (see number_literal.h)
+word_type number_literal_value(const char *text, size_t len)
+{
+    unsigned long val = accumulate_digits(text, len);
+    if (INT_MAX < val) {
+	char msgbuf[512];
+	if (len >= MAX_SHOWN_DIGITS) {
+	    snprintf(msgbuf, 327, "Number (%s...) is too large!", text);
+	} else {
+	    sprintf(msgbuf, "Number (%s) is too large!", text);
+	}
+	yyerror(lexer_filename(), msgbuf);
+    }
+    return (int) val;
+}
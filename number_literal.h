@@ -0,0 +1,18 @@
+#ifndef _NUMBER_LITERAL_H
+#define _NUMBER_LITERAL_H
+
+#include <stddef.h>
+#include "machine_types.h"
+
+// Conversion of the text of a number token to its value,
+// shared by the flex scanner and the hand-written scanner.
+
+// Requires: text points to len decimal digits, followed by a null char
+// Return the value of the number written as text.
+// The digits are converted as sscanf's "%lu" format would
+// (giving ULONG_MAX if they are too large for an unsigned long),
+// and if that is larger than INT_MAX, the number is reported
+// (with yyerror) as too large and the result is that value cast to int.
+extern word_type number_literal_value(const char *text, size_t len);
+
+#endif
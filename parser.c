@@ -8,13 +8,22 @@
 // putting the AST into progast
 extern int yyparse (char const *file_name);
 
+// the number of syntax errors the parser has reported
+extern int yynerrs;
+
 // Parse a PL/0 program using the tokens from the lexer,
 // returning the program's AST
 extern block_t parseProgram(char const *file_name)
 {
+    // the parser does not reset its error count itself
+    yynerrs = 0;
     int rc = yyparse(file_name);
     if (rc != 0) {
-	exit(rc);
+	exit_with_error(rc);
+    }
+    if (yynerrs > 0) {
+	// the parser recovered from its errors, but the AST is not usable
+	exit_with_error(EXIT_FAILURE);
     }
     return progast;
 }
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include <assert.h>
 #include "scope.h"
 #include "utilities.h"
@@ -17,11 +18,108 @@ scope_t *scope_create()
     }
     new_s->size = 0;
     new_s->loc_count = 0;
-    for (int j = 0; j < MAX_SCOPE_SIZE; j++)
+    new_s->entries = NULL;
+    new_s->capacity = 0;
+    new_s->index = NULL;
+    new_s->index_capacity = 0;
+    return new_s;
+}
+
+// Remove all the associations from s, freeing their id_attrs,
+// but keep s's storage, so that s can be used again for another scope.
+void scope_clear(scope_t *s)
+{
+    if (s->size == 0)
     {
-        new_s->entries[j] = NULL;
+        return;
     }
-    return new_s;
+    for (unsigned int pos = 0; pos < s->size; pos++)
+    {
+        free(s->entries[pos].attrs);
+    }
+    memset(s->index, 0, s->index_capacity * sizeof(unsigned int));
+    s->size = 0;
+    s->loc_count = 0;
+}
+
+// Initial number of associations a scope has room for
+#define INITIAL_SCOPE_CAPACITY 8
+
+// Initial number of slots in a scope's hash index
+#define INITIAL_INDEX_CAPACITY (2 * INITIAL_SCOPE_CAPACITY)
+
+// Requires: name was returned by intern_string
+// Return a hash code for the given name.
+// Since names are interned, the address identifies the name.
+// Interned names are evenly spaced in memory, so all the bits of the
+// address are mixed (as in MurmurHash3's fmix64),
+// which lets the hash tables use just the low bits of the result.
+unsigned int scope_hash(const char *name)
+{
+    uint64_t a = (uint64_t)(uintptr_t)name;
+    a ^= a >> 33;
+    a *= 0xff51afd7ed558ccdULL;
+    a ^= a >> 33;
+    a *= 0xc4ceb9fe1a85ec53ULL;
+    a ^= a >> 33;
+    return (unsigned int)a;
+}
+
+// Requires: s->index != NULL and there is an empty slot in s->index
+// Record in s->index that the association entries[pos] has the given hash
+static void scope_index_put(scope_t *s, unsigned int hash, unsigned int pos)
+{
+    unsigned int mask = s->index_capacity - 1;
+    unsigned int i = hash & mask;
+    while (s->index[i] != 0)
+    {
+        i = (i + 1) & mask;
+    }
+    s->index[i] = pos + 1;
+}
+
+// Make sure that s->index has room for one more association,
+// keeping the load factor of the index at most 1/2.
+static void scope_index_reserve(scope_t *s)
+{
+    if (s->index != NULL && 2 * (s->size + 1) <= s->index_capacity)
+    {
+        return;
+    }
+    unsigned int new_cap = (s->index == NULL) ? INITIAL_INDEX_CAPACITY
+                                              : 2 * s->index_capacity;
+    unsigned int *new_index = (unsigned int *)calloc(new_cap, sizeof(unsigned int));
+    if (new_index == NULL)
+    {
+        bail_with_error("No space for scope index!");
+    }
+    free(s->index);
+    s->index = new_index;
+    s->index_capacity = new_cap;
+    for (unsigned int pos = 0; pos < s->size; pos++)
+    {
+        scope_index_put(s, s->entries[pos].hash, pos);
+    }
+}
+
+// Make sure that s->entries has room for one more association,
+// doubling its capacity when it is full.
+static void scope_entries_reserve(scope_t *s)
+{
+    if (s->size < s->capacity)
+    {
+        return;
+    }
+    unsigned int new_cap = (s->entries == NULL) ? INITIAL_SCOPE_CAPACITY
+                                                : 2 * s->capacity;
+    scope_assoc_t *new_entries
+        = (scope_assoc_t *)realloc(s->entries, new_cap * sizeof(scope_assoc_t));
+    if (new_entries == NULL)
+    {
+        bail_with_error("No space for scope entries!");
+    }
+    s->entries = new_entries;
+    s->capacity = new_cap;
 }
 
 // Return the number of constant and variables declarations
@@ -38,29 +136,34 @@ unsigned int scope_size(scope_t *s)
 }
 
 // Is the current scope full?
+// (Scopes grow on demand, and bail if there is no space,
+// so this is always false.)
 bool scope_full(scope_t *s)
 {
-    return scope_size(s) >= MAX_SCOPE_SIZE;
+    return false;
 }
 
-// Requires: assoc != NULL && !scope_full() && !scope_declared(assoc->id);
-// Add an association from the given name to the given id attributes
-// in the current scope.
+// Requires: assoc != NULL && !scope_declared(assoc->id);
+// Add (a copy of) the association from the given name
+// to the given id attributes in the current scope.
 // If assoc->attrs->kind != procedure_idk,
 // then this stores the scope_count value into assoc->attrs->offset_count
 // and then increases loc_count by 1.
-static void scope_add(scope_t *s, scope_assoc_t *assoc)
+static void scope_add(scope_t *s, scope_assoc_t assoc)
 {
-    // assert(assoc != NULL);
-    // assert(!scope_full());
-    // assert(!scope_declared(assoc->id));
-    assoc->attrs->offset_count = (s->loc_count)++;
+    // assert(assoc.attrs != NULL);
+    // assert(!scope_declared(assoc.id));
+    scope_entries_reserve(s);
+    scope_index_reserve(s);
+    assoc.attrs->offset_count = (s->loc_count)++;
+    scope_index_put(s, assoc.hash, s->size);
     s->entries[(s->size)++] = assoc;
-    // fprintf(stderr, "assoc->attrs->offset_count is %d\n",
-    //         assoc->attrs->offset_count);
+    // fprintf(stderr, "assoc.attrs->offset_count is %d\n",
+    //         assoc.attrs->offset_count);
 }
 
-// Requires: !scope_declared(name) && attrs != NULL;
+// Requires: !scope_declared(name) && attrs != NULL
+//           && name was returned by intern_string;
 // Modify the current scope symbol table to
 // add an association from the given name to the given id_attrs attrs,
 // and if attrs->kind != procedure,
@@ -71,17 +174,14 @@ void scope_insert(scope_t *s, const char *name, id_attrs *attrs)
     // assert(!scope_declared(name));
     // assert(attrs != NULL);
     // debug_print("Running scope_insert for name "%s\"\n", name);
-    scope_assoc_t *new_assoc = malloc(sizeof(scope_assoc_t));
-    if (new_assoc == NULL)
-    {
-        bail_with_error("No space for association!");
-    }
-    new_assoc->id = name;
-    new_assoc->attrs = attrs;
+    scope_assoc_t new_assoc;
+    new_assoc.id = name;
+    new_assoc.hash = scope_hash(name);
+    new_assoc.attrs = attrs;
     scope_add(s, new_assoc);
 }
 
-// Requires: name != NULL;
+// Requires: name != NULL && name was returned by intern_string;
 // Is the given name associated with some attributes in the current scope?
 bool scope_declared(scope_t *s, const char *name)
 {
@@ -91,32 +191,31 @@ bool scope_declared(scope_t *s, const char *name)
     return scope_lookup(s, name) != NULL;
 }
 
-// Requires: name != NULL and scope_initialize() has been called previously.
+// Requires: name != NULL and name was returned by intern_string.
 // Return (a pointer to) the attributes of the given name in the current scope
 // or NULL if there is no association for name.
 id_attrs *scope_lookup(scope_t *s, const char *name)
 {
-    int i;
     // assert(name != NULL);
     // assert(s != NULL);
     // debug_print("Entering scope_lookup for \"%s\"\n", name);
-    for (i = 0; i < s->size; i++)
+    if (s->index == NULL)
+    {
+        return NULL;
+    }
+    unsigned int hash = scope_hash(name);
+    unsigned int mask = s->index_capacity - 1;
+    for (unsigned int i = hash & mask; s->index[i] != 0; i = (i + 1) & mask)
     {
-        // assert(s != NULL);
-        // assert(s->entries != NULL);
-        // assert(0 <= i && i < s->size);
-        // assert(s->entries[i] != NULL);
-        // assert(s->entries[i]->id != NULL);
-        // debug_print("Past asserts in scope_lookup loop\n");
-        // debug_print("Length of name is %d\n", strlen(name));
-        if (strcmp(s->entries[i]->id, name) == 0)
+        scope_assoc_t *assoc = &(s->entries[s->index[i] - 1]);
+        // assert(assoc->id != NULL);
+        if (assoc->id == name)
         {
             // debug_print("scope_lookup(\"%s\") returning attributes\n",
             //		name);
-            return s->entries[i]->attrs;
+            return assoc->attrs;
         }
     }
-    // assert(i == s->size);
     // debug_print("The scope_lookup call on \"%s\" returns NULL\n", name);
     return NULL;
 }
\ No newline at end of file
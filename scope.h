@@ -6,28 +6,49 @@
 #include "machine_types.h"
 #include "id_attrs.h"
 
-// Maximum number of declarations
-// that can be stored in a scope
-#define MAX_SCOPE_SIZE 4096
-
+// The names in a scope are interned (see intern.h),
+// so they are compared by address.
 typedef struct {
     const char *id;
+    // hash of id, computed once when the association is made
+    unsigned int hash;
     id_attrs *attrs;
 } scope_assoc_t;
 
-// Invariant: 0 <= size < MAX_SCOPE_SIZE;
+// Invariant: 0 <= size <= capacity;
+// Invariant: index == NULL || 2 * size <= index_capacity;
 typedef struct scope_s {
     unsigned int size;
     // num. of associations in this scope
     unsigned int loc_count;
-    scope_assoc_t *entries[MAX_SCOPE_SIZE];
+    // associations in the order they were declared,
+    // the array has room for capacity associations
+    // (it is NULL until the first association is added
+    // and is grown geometrically as needed)
+    scope_assoc_t *entries;
+    unsigned int capacity;
+    // open addressing hash table mapping names to positions in entries;
+    // each slot holds (position + 1), with 0 meaning an empty slot.
+    // It is NULL until the first association is added,
+    // and index_capacity is always a power of 2.
+    unsigned int *index;
+    unsigned int index_capacity;
 } scope_t;
 
+// Requires: name was returned by intern_string
+// Return a hash code for the given name
+// (computed from its address, as names are interned).
+extern unsigned int scope_hash(const char *name);
+
 // Allocate a fresh scope symbol table and return (a pointer to) it.
 // Issues an error message (on stderr) if there is no space
 // and exits with a failure error code in that case.
 extern scope_t *scope_create();
 
+// Remove all the associations from s, freeing their id_attrs,
+// but keep s's storage, so that s can be used again for another scope.
+extern void scope_clear(scope_t *s);
+
 // Return the number of constant and variables declarations
 // that have been added to this scope.
 extern address_type scope_loc_count(scope_t *s);
@@ -36,12 +57,15 @@ extern address_type scope_loc_count(scope_t *s);
 extern unsigned int scope_size(scope_t *s);
 
 // Is the current scope full?
+// (Scopes grow as needed, and bail with an error if there is
+// no more space to allocate, so this is always false.)
 extern bool scope_full(scope_t *s);
 
+// Requires: name was returned by intern_string
 // Is the given name associated with some attributes in the current scope?
 extern bool scope_declared(scope_t *s, const char *name);
 
-// Requires: attrs != NULL &&
+// Requires: attrs != NULL && name was returned by intern_string &&
 //                  !scope_declared(name);
 // Add an association from name to attrs,
 // store the next_loc_offset value into
@@ -49,6 +73,7 @@ extern bool scope_declared(scope_t *s, const char *name);
 // the next_loc_offset for s by 1.
 extern void scope_insert(scope_t *s,const char *name, id_attrs *attrs);
 
+// Requires: name was returned by intern_string
 // Return (a pointer to) the attributes
 // of the given name in s
 // or NULL if name is not declared in s
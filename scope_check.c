@@ -11,119 +11,120 @@
 #include "id_use.h"
 #include <assert.h>
 
+static void scope_check_declare_name(file_location floc, const char *name,
+                                     AST_type vt, id_kind kind);
+
 // Build the symbol table for prog
 // and check for duplicate declarations
 // or uses of undeclared identifiers
-void scope_check_program(block_t prog)
+void scope_check_program(block_t *prog)
 {
     symtab_enter_scope();
-    scope_check_constDecls(prog.const_decls);
-    scope_check_varDecls(prog.var_decls);
-    scope_check_procDecls(prog.proc_decls);
-    scope_check_stmts(prog.stmts);
+    scope_check_constDecls(&prog->const_decls);
+    scope_check_varDecls(&prog->var_decls);
+    scope_check_procDecls(&prog->proc_decls);
+    scope_check_stmts(&prog->stmts);
     symtab_leave_scope();
 }
 
 // declare all procedure identifiers
-void scope_check_procDecls(proc_decls_t pds)
+void scope_check_procDecls(proc_decls_t *pds)
 {
-    proc_decl_t *pdp = pds.proc_decls;
+    proc_decl_t *pdp = pds->proc_decls;
     while (pdp != NULL)
     {
-        scope_check_procDecl(*pdp);
+        scope_check_procDecl(pdp);
         pdp = pdp->next;
     }
 }
 
-void scope_check_procDecl(proc_decl_t pd)
+void scope_check_procDecl(proc_decl_t *pd)
 {
     // check if the procedure name is already declared
-    if (symtab_declared_in_current_scope(pd.name))
+    if (symtab_declared_in_current_scope(pd->name))
     {
-        bail_with_prog_error(
-            *(pd.file_loc),
+        report_prog_error(
+            pd->file_loc,
             "procedure \"%s\" is already declared",
-            pd.name);
-        exit(EXIT_FAILURE);
+            pd->name);
     }
     else
     {
         // declare the name of the procedure
         int ofst_cnt = symtab_scope_loc_count();
-        id_attrs *attrs = create_id_attrs(*(pd.file_loc), pd.type_tag, ofst_cnt);
-        symtab_insert(pd.name, attrs);
+        id_attrs *attrs = create_id_attrs(pd->file_loc, pd->type_tag, ofst_cnt);
+        symtab_insert(pd->name, attrs);
     }
     
     // check the block of the procedure
-    scope_check_program(*(pd.block));
+    scope_check_program(pd->block);
 }
 
 // check that all identifiers used in exp
 // have been declared
 // (if not, then produce an error)
 
-void scope_check_binary_op_expr(binary_op_expr_t exp)
+void scope_check_binary_op_expr(binary_op_expr_t *exp)
 {
-    scope_check_expr(*(exp.expr1));
+    scope_check_expr(exp->expr1);
     // (note: no identifiers can occur in the operator)
-    scope_check_expr(*(exp.expr2));
+    scope_check_expr(exp->expr2);
 }
 
 // declare all constant identifiers
-void scope_check_constDecls(const_decls_t cds)
+void scope_check_constDecls(const const_decls_t *cds)
 {
-    const_decl_t *cdp = cds.start;
+    const const_decl_t *cdp = cds->start;
     while (cdp != NULL)
     {
-        scope_check_constDecl(*cdp);
+        scope_check_constDecl(cdp);
         cdp = cdp->next;
     }
 }
 
-void scope_check_constDecl(const_decl_t cd)
+void scope_check_constDecl(const const_decl_t *cd)
 {
-    const_def_list_t cdl = cd.const_def_list;
-    const_def_t *cdp = cdl.start;
+    const const_def_t *cdp = cd->const_def_list.start;
     while (cdp != NULL)
     {
-        scope_check_constDef(*cdp);
+        scope_check_constDef(cdp);
         cdp = cdp->next;
     }
 }
 
-void scope_check_constDef(const_def_t cd)
+void scope_check_constDef(const const_def_t *cd)
 {
-    scope_check_declare_ident(cd.ident, cd.type_tag, constant_idk);
+    scope_check_declare_ident(&cd->ident, cd->type_tag, constant_idk);
 }
 
 // build the symbol table
 // and check the declarations in vds
-void scope_check_varDecls(var_decls_t vds)
+void scope_check_varDecls(const var_decls_t *vds)
 {
-    var_decl_t *vdp = vds.var_decls;
+    const var_decl_t *vdp = vds->var_decls;
     while (vdp != NULL)
     {
-        scope_check_varDecl(*vdp);
+        scope_check_varDecl(vdp);
         vdp = vdp->next;
     }
 }
 
 // Add declarations for the names in vd,
 // reporting duplicate declarations
-void scope_check_varDecl(var_decl_t vd)
+void scope_check_varDecl(const var_decl_t *vd)
 {
-    scope_check_idents(vd.ident_list, vd.type_tag, variable_idk);
+    scope_check_idents(&vd->ident_list, vd->type_tag, variable_idk);
 }
 
 // Add declarations for the names in ids
 // to current scope as type vt
 // reporting any duplicate declarations
-void scope_check_idents(ident_list_t ids, AST_type vt, id_kind kind)
+void scope_check_idents(const ident_list_t *ids, AST_type vt, id_kind kind)
 {
-    ident_t *idp = ids.start;
+    const ident_t *idp = ids->start;
     while (idp != NULL)
     {
-        scope_check_declare_ident(*idp, vt, kind);
+        scope_check_declare_ident(idp, vt, kind);
         idp = idp->next;
     }
 }
@@ -131,12 +132,21 @@ void scope_check_idents(ident_list_t ids, AST_type vt, id_kind kind)
 // Add declaration for id
 // to current scope as type vt
 // reporting if it's a duplicate declaration
-void scope_check_declare_ident(ident_t id, AST_type vt, id_kind kind)
+void scope_check_declare_ident(const ident_t *id, AST_type vt, id_kind kind)
+{
+    scope_check_declare_name(id->file_loc, id->name, vt, kind);
+}
+
+// Add declaration for name (declared at floc)
+// to current scope as type vt
+// reporting if it's a duplicate declaration
+static void scope_check_declare_name(file_location floc, const char *name,
+                                     AST_type vt, id_kind kind)
 {
-    if (symtab_declared_in_current_scope(id.name))
+    if (symtab_declared_in_current_scope(name))
     {
         // Get existing identifier's kind
-        id_kind existing_kind = symtab_lookup(id.name)->attrs->kind;
+        id_kind existing_kind = symtab_lookup(name).attrs->kind;
         
         const char *existing_kind_str = (existing_kind == 6) ? "variable" :
                                         (existing_kind == 4) ? "constant" :
@@ -145,19 +155,18 @@ void scope_check_declare_ident(ident_t id, AST_type vt, id_kind kind)
         const char *new_kind_str = (kind == variable_idk) ? "variable" :
                                    (kind == constant_idk) ? "constant" : "procedure";
 
-        bail_with_prog_error(
-            *(id.file_loc),
+        report_prog_error(
+            floc,
             "%s \"%s\" is already declared as a %s",
             new_kind_str,
-            id.name,
+            name,
             existing_kind_str);
-        exit(EXIT_FAILURE);
     }
     else
     {
         int ofst_cnt = symtab_scope_loc_count();
-        id_attrs *attrs = create_id_attrs(*(id.file_loc), vt, ofst_cnt);
-        symtab_insert(id.name, attrs);
+        id_attrs *attrs = create_id_attrs(floc, vt, ofst_cnt);
+        symtab_insert(name, attrs);
     }
 }
 
@@ -165,16 +174,20 @@ void scope_check_declare_ident(ident_t id, AST_type vt, id_kind kind)
 //  check the statements to make sure that
 //  all idenfifiers referenced in them have been declared
 //  (if not, then produce an error)
-//  Return the modified AST with id_use pointers
+//  and record the lexical address of each use in the AST
 
-void scope_check_stmts(stmts_t stmts)
+void scope_check_stmts(stmts_t *stmts)
 {
-    stmt_t *sp = stmts.stmt_list.start;
+    if (stmts->stmts_kind == empty_stmts_e)
+    {
+        return;
+    }
+    stmt_t *sp = stmts->stmt_list.start;
 
     while (sp != NULL)
     {
 
-        scope_check_stmt(*sp);
+        scope_check_stmt(sp);
 
         sp = sp->next;
     }
@@ -184,30 +197,30 @@ void scope_check_stmts(stmts_t stmts)
 // all idenfifiers used have been declared
 // (if not, then produce an error)
 
-void scope_check_stmt(stmt_t stmt)
+void scope_check_stmt(stmt_t *stmt)
 {
-    switch (stmt.stmt_kind)
+    switch (stmt->stmt_kind)
     {
     case assign_stmt:
-        scope_check_assignStmt(stmt.data.assign_stmt); //
+        scope_check_assignStmt(&stmt->data.assign_stmt); //
         break;
     case call_stmt:
-        scope_check_callStmt(stmt.data.call_stmt); //
+        scope_check_callStmt(&stmt->data.call_stmt); //
         break;
     case while_stmt:
-        scope_check_whileStmt(stmt.data.while_stmt); //
+        scope_check_whileStmt(&stmt->data.while_stmt); //
         break;
     case if_stmt:
-        scope_check_ifStmt(stmt.data.if_stmt); //
+        scope_check_ifStmt(&stmt->data.if_stmt); //
         break;
     case read_stmt:
-        scope_check_readStmt(stmt.data.read_stmt); //
+        scope_check_readStmt(&stmt->data.read_stmt); //
         break;
     case print_stmt:
-        scope_check_printStmt(stmt.data.print_stmt); //
+        scope_check_printStmt(&stmt->data.print_stmt); //
         break;
     case block_stmt:
-        scope_check_blockStmt(stmt.data.block_stmt);
+        scope_check_blockStmt(&stmt->data.block_stmt);
         break;
     default:
         bail_with_error("Call to scope_check_stmt with an AST that is not a statement!");
@@ -215,140 +228,132 @@ void scope_check_stmt(stmt_t stmt)
     }
 }
 
+// Return the lexical address for the use of name at floc,
+// producing an error if name has not been declared
+static lexical_address scope_check_resolve(file_location floc,
+                                           const char *name)
+{
+    id_use idu = scope_check_ident_declared(floc, name);
+    if (idu.attrs == NULL)
+    {
+        // only when checking goes on after errors
+        return lexical_address_unresolved();
+    }
+    return id_use_2_lexical_address(idu);
+}
+
 // check the statement for
 // undeclared identifiers
-// Return the modified AST with id_use pointers
-void scope_check_assignStmt(assign_stmt_t stmt)
+// and record the lexical address of the assigned name
+void scope_check_assignStmt(assign_stmt_t *stmt)
 {
-
-    const char *name = stmt.name;
-    scope_check_ident_declared(*(stmt.file_loc), name);
-    // assert(stmt.idu != NULL);  // since would bail if not declared or use bail_with_prog_error
-    scope_check_expr(*(stmt.expr));
+    stmt->lex_addr = scope_check_resolve(stmt->file_loc, stmt->name);
+    scope_check_expr(stmt->expr);
 }
 
-void scope_check_callStmt(call_stmt_t stmt)
+void scope_check_callStmt(call_stmt_t *stmt)
 {
     // Check that the function name used in the call statement is declared
-    scope_check_ident_declared(*(stmt.file_loc), stmt.name);
+    stmt->lex_addr = scope_check_resolve(stmt->file_loc, stmt->name);
 }
 
-void scope_check_printStmt(print_stmt_t stmt)
+void scope_check_printStmt(print_stmt_t *stmt)
 {
-    scope_check_ident_expr(stmt.expr.data.ident);
-    scope_check_expr(stmt.expr);
-    /*
-    const char *name = stmt.name;
-    assert(stmt.idu != NULL);  // since would bail if not declared or use bail_with_prog_error
-    *stmt.expr = scope_check_expr(*(stmt.expr));
-   */
+    scope_check_expr(&stmt->expr);
 }
 
-void scope_check_blockStmt(block_stmt_t stmt)
+void scope_check_blockStmt(block_stmt_t *stmt)
 {
-    /*
-    const char *name = stmt.name;
-    scope_check_ident_declared(*(stmt.file_loc),name);
-    assert(stmt.idu != NULL);  // since would bail if not declared or use bail_with_prog_error
-    *stmt.expr = scope_check_expr(*(stmt.expr));
-   */
     // Enter a new scope for the block
     symtab_enter_scope();
     // Check all the statements within the block
-    scope_check_varDecls(stmt.block->var_decls);
-    scope_check_stmts((stmt.block->stmts));
+    scope_check_varDecls(&stmt->block->var_decls);
+    scope_check_stmts(&stmt->block->stmts);
     // Leave the scope after checking the block
     symtab_leave_scope();
 }
 
-// check the statement to make sure that
+// check the condition to make sure that
 // all idenfifiers referenced in it have been declared
 // (if not, then produce an error)
-// Return the modified AST with id_use pointers
-
-void scope_check_ifStmt(if_stmt_t stmt)
+static void scope_check_condition(condition_t *cond)
 {
-    // Check if condition
-    // Check the condition expression C for undeclared identifiers
-    if (stmt.condition.cond_kind == ck_db)
+    if (cond->cond_kind == ck_db)
     {
-        scope_check_expr(stmt.condition.data.db_cond.dividend);
-        scope_check_expr(stmt.condition.data.db_cond.divisor);
+        scope_check_expr(&cond->data.db_cond.dividend);
+        scope_check_expr(&cond->data.db_cond.divisor);
     }
     else
     {
-        scope_check_expr(stmt.condition.data.rel_op_cond.expr1);
-        scope_check_expr(stmt.condition.data.rel_op_cond.expr2);
+        scope_check_expr(&cond->data.rel_op_cond.expr1);
+        scope_check_expr(&cond->data.rel_op_cond.expr2);
     }
+}
+
+// check the statement to make sure that
+// all idenfifiers referenced in it have been declared
+// (if not, then produce an error)
+// and record the lexical address of each use in the AST
+
+void scope_check_ifStmt(if_stmt_t *stmt)
+{
+    // Check the condition expression C for undeclared identifiers
+    scope_check_condition(&stmt->condition);
 
     // Check the statement list S1 for identifiers
-    scope_check_stmts(*stmt.then_stmts);
+    scope_check_stmts(stmt->then_stmts);
 
     // Check the else part S2 if it exists
-    if (stmt.else_stmts != NULL)
+    if (stmt->else_stmts != NULL)
     {
-        scope_check_stmts(*stmt.else_stmts);
+        scope_check_stmts(stmt->else_stmts);
     }
 }
 
 // check the statement to make sure that
 // all idenfifiers referenced in it have been declared
 // (if not, then produce an error)
-// Return the modified AST with id_use pointers
+// and record the lexical address of the name read into
 
-void scope_check_readStmt(read_stmt_t stmt)
+void scope_check_readStmt(read_stmt_t *stmt)
 {
-    /*
-    stmt.idu = scope_check_ident_declared(*(stmt.file_loc),stmt.name);
-  */
-    const char *name = stmt.name;
     // Check if the identifier is declared
-    scope_check_ident_declared(*(stmt.file_loc), name);
+    stmt->lex_addr = scope_check_resolve(stmt->file_loc, stmt->name);
 }
 
 // check the statement to make sure that
 // all idenfifiers referenced in it have been declared
 // (if not, then produce an error)
-// Return the modified AST with id_use pointers
+// and record the lexical address of each use in the AST
 
-void scope_check_whileStmt(while_stmt_t stmt)
+void scope_check_whileStmt(while_stmt_t *stmt)
 {
     // Check the condition
-    if (stmt.condition.cond_kind == ck_db)
-    {
-        scope_check_expr(stmt.condition.data.db_cond.dividend);
-        scope_check_expr(stmt.condition.data.db_cond.divisor);
-    }
-    else
-    {
-        scope_check_expr(stmt.condition.data.rel_op_cond.expr1);
-        scope_check_expr(stmt.condition.data.rel_op_cond.expr2);
-    }
+    scope_check_condition(&stmt->condition);
 
     // Check the statement list
-    scope_check_stmts(*(stmt.body));
+    scope_check_stmts(stmt->body);
 }
 
 // check id to make sure that
 // all it has been declared
 // (if not, then produce an error)
+// and record its lexical address
 
-void scope_check_ident_expr(ident_t id)
+void scope_check_ident_expr(ident_t *id)
 {
-
-    scope_check_ident_declared(*(id.file_loc), id.name);
+    id->lex_addr = scope_check_resolve(id->file_loc, id->name);
 }
 
-id_use *scope_check_ident_declared(file_location floc, const char *name)
+id_use scope_check_ident_declared(file_location floc, const char *name)
 {
-    id_use *ret = symtab_lookup(name);
-    if (ret == NULL)
+    id_use ret = symtab_lookup(name);
+    if (ret.attrs == NULL)
     {
-        bail_with_prog_error(floc,
-                             "identifier \"%s\" is not declared!",
-                             name);
+        report_prog_error(floc,
+                          "identifier \"%s\" is not declared!",
+                          name);
     }
-    // assert(id_use_get_attrs(ret) != NULL);
     return ret;
 }
 
@@ -356,24 +361,182 @@ id_use *scope_check_ident_declared(file_location floc, const char *name)
 // all idenfifiers used have been declared
 // (if not, then produce an error)
 
-void scope_check_expr(expr_t exp)
+void scope_check_expr(expr_t *exp)
 {
-    switch (exp.expr_kind)
+    switch (exp->expr_kind)
     {
     case expr_bin:
-        scope_check_binary_op_expr(exp.data.binary);
+        scope_check_binary_op_expr(&exp->data.binary);
         break;
     case expr_ident:
-        scope_check_ident_expr(exp.data.ident);
+        scope_check_ident_expr(&exp->data.ident);
         break;
     case expr_number:
         // no identifiers in numbers
         break;
     case expr_negated:
-        scope_check_expr(*exp.data.negated.expr);
+        scope_check_expr(exp->data.negated.expr);
         break;
     default:
         bail_with_error("Unknown expression kind encountered during scope checking!");
         break;
     }
 }
+
+// The rest of this file checks a flat AST (see flat_ast.h)
+// in the same way, and with the same error messages, as above
+
+static void scope_check_flat_block(flat_ast_t *fa, flat_index bi,
+                                   bool whole_block);
+
+// check that the name of the ident with index ii has been declared
+// and record the lexical address of that use
+static void scope_check_flat_ident(flat_ast_t *fa, flat_index ii)
+{
+    flat_ident_t *id = &fa->idents[ii];
+    id->lex_addr = scope_check_resolve(id->file_loc, id->name);
+}
+
+// check the expression with index ei for undeclared identifiers
+static void scope_check_flat_expr(flat_ast_t *fa, flat_index ei)
+{
+    const flat_expr_t *exp = &fa->exprs[ei];
+    switch (exp->expr_kind)
+    {
+    case expr_bin:
+        scope_check_flat_expr(fa, exp->data.binary.expr1);
+        scope_check_flat_expr(fa, exp->data.binary.expr2);
+        break;
+    case expr_ident:
+        scope_check_flat_ident(fa, exp->data.ident);
+        break;
+    case expr_number:
+        // no identifiers in numbers
+        break;
+    case expr_negated:
+        scope_check_flat_expr(fa, exp->data.negated);
+        break;
+    default:
+        bail_with_error("Unknown expression kind encountered during scope checking!");
+        break;
+    }
+}
+
+// check the condition with index ci for undeclared identifiers
+static void scope_check_flat_condition(flat_ast_t *fa, flat_index ci)
+{
+    scope_check_flat_expr(fa, fa->conditions[ci].expr1);
+    scope_check_flat_expr(fa, fa->conditions[ci].expr2);
+}
+
+// check the statements in the range sr for undeclared identifiers
+static void scope_check_flat_stmts(flat_ast_t *fa, flat_range sr)
+{
+    for (flat_index i = sr.first; i < sr.first + sr.count; i++)
+    {
+        const flat_stmt_t *s = &fa->stmts[i];
+        switch (s->stmt_kind)
+        {
+        case assign_stmt:
+            scope_check_flat_ident(fa, s->data.assign_stmt.ident);
+            scope_check_flat_expr(fa, s->data.assign_stmt.expr);
+            break;
+        case call_stmt:
+            scope_check_flat_ident(fa, s->data.call_stmt);
+            break;
+        case while_stmt:
+            scope_check_flat_condition(fa, s->data.while_stmt.condition);
+            scope_check_flat_stmts(fa, s->data.while_stmt.body);
+            break;
+        case if_stmt:
+            scope_check_flat_condition(fa, s->data.if_stmt.condition);
+            scope_check_flat_stmts(fa, s->data.if_stmt.then_stmts);
+            if (s->data.if_stmt.has_else)
+            {
+                scope_check_flat_stmts(fa, s->data.if_stmt.else_stmts);
+            }
+            break;
+        case read_stmt:
+            scope_check_flat_ident(fa, s->data.read_stmt);
+            break;
+        case print_stmt:
+            scope_check_flat_expr(fa, s->data.print_stmt);
+            break;
+        case block_stmt:
+            scope_check_flat_block(fa, s->data.block_stmt, false);
+            break;
+        default:
+            bail_with_error("Call to scope_check_stmt with an AST that is not a statement!");
+            break;
+        }
+    }
+}
+
+// check the block with index bi in a new scope;
+// as for block statements above, only the variable declarations
+// and statements are checked unless whole_block is true
+static void scope_check_flat_block(flat_ast_t *fa, flat_index bi,
+                                   bool whole_block)
+{
+    const flat_block_t *blk = &fa->blocks[bi];
+    symtab_enter_scope();
+    if (whole_block)
+    {
+        for (flat_index i = blk->const_decls.first;
+             i < blk->const_decls.first + blk->const_decls.count; i++)
+        {
+            flat_range defs = fa->const_decls[i];
+            for (flat_index j = defs.first; j < defs.first + defs.count; j++)
+            {
+                const flat_ident_t *id = &fa->idents[fa->const_defs[j].ident];
+                scope_check_declare_name(id->file_loc, id->name,
+                                         const_def_ast, constant_idk);
+            }
+        }
+    }
+    for (flat_index i = blk->var_decls.first;
+         i < blk->var_decls.first + blk->var_decls.count; i++)
+    {
+        flat_range ids = fa->var_decls[i];
+        for (flat_index j = ids.first; j < ids.first + ids.count; j++)
+        {
+            scope_check_declare_name(fa->idents[j].file_loc,
+                                     fa->idents[j].name,
+                                     var_decl_ast, variable_idk);
+        }
+    }
+    if (whole_block)
+    {
+        for (flat_index i = blk->proc_decls.first;
+             i < blk->proc_decls.first + blk->proc_decls.count; i++)
+        {
+            const flat_proc_decl_t *pd = &fa->proc_decls[i];
+            const flat_ident_t *id = &fa->idents[pd->ident];
+            if (symtab_declared_in_current_scope(id->name))
+            {
+                report_prog_error(
+                    id->file_loc,
+                    "procedure \"%s\" is already declared",
+                    id->name);
+            }
+            else
+            {
+                int ofst_cnt = symtab_scope_loc_count();
+                id_attrs *attrs = create_id_attrs(id->file_loc, proc_decl_ast,
+                                                  ofst_cnt);
+                symtab_insert(id->name, attrs);
+            }
+            scope_check_flat_block(fa, pd->block, true);
+        }
+    }
+    scope_check_flat_stmts(fa, blk->stmts);
+    symtab_leave_scope();
+}
+
+// Build the symbol table for the flat AST fa
+// and check for duplicate declarations
+// or uses of undeclared identifiers
+void scope_check_flat_program(flat_ast_t *fa)
+{
+    scope_check_flat_block(fa, fa->program, true);
+}
@@ -4,6 +4,7 @@
 #include "id_use.h"
 #include "type_exp.h"
 #include "id_attrs.h"
+#include "flat_ast.h"
 
 
 // varType ::= float | bool
@@ -13,100 +14,133 @@ typedef enum {float_type, bool_type
 // Build the symbol table for the given program AST
 // and check the given program AST for duplicate declarations
 // or uses of identifiers that were not declared
-extern void scope_check_program(block_t prog);
+extern void scope_check_program(block_t *prog);
+
+// Add declarations for the names of the constants in cds
+// to the current scope's symbol table,
+// producing errors for duplicate declarations
+extern void scope_check_constDecls(const const_decls_t *cds);
+
+// Add declarations for the names of the constants in cd
+// to the current scope's symbol table,
+// producing errors for duplicate declarations
+extern void scope_check_constDecl(const const_decl_t *cd);
+
+// Add a declaration for the name of the constant defined by cd
+// to the current scope's symbol table,
+// producing an error if it is a duplicate declaration
+extern void scope_check_constDef(const const_def_t *cd);
 
 // build the symbol table and check the declarations in vds
-extern void scope_check_varDecls(var_decls_t vds);
+extern void scope_check_varDecls(const var_decls_t *vds);
 
 // Add declarations to the current scope's symbol table for vd,
 // producing errors for duplicate declarations
-extern void scope_check_varDecl(var_decl_t vd);
+extern void scope_check_varDecl(const var_decl_t *vd);
 
 // Add declarations for the names in ids to the current scope's symbol table,
 // for variables of the type t,
 // producing errors for any duplicate declarations
-extern void scope_check_idents(ident_list_t ids, AST_type t, id_kind kind);
+extern void scope_check_idents(const ident_list_t *ids, AST_type t,
+                               id_kind kind);
+
+// Add declarations for the names of the procedures in pds
+// to the current scope's symbol table,
+// and check each procedure's block in its own scope
+extern void scope_check_procDecls(proc_decls_t *pds);
+
+// Add a declaration for the name of the procedure pd
+// to the current scope's symbol table
+// (producing an error if it is a duplicate declaration),
+// and check its block in a new scope
+extern void scope_check_procDecl(proc_decl_t *pd);
 
 // check the statements to make sure that
 // all idenfifiers referenced in them have been declared
 // (if not, then produce an error)
-// Return the modified AST with id_use pointers
-extern void scope_check_stmts(stmts_t stmts);
+// and record the lexical address of each use in the AST
+extern void scope_check_stmts(stmts_t *stmts);
 
 // check the statement to make sure that
 // all idenfifiers referenced in it have been declared
 // (if not, then produce an error)
-// Return the modified AST with id_use pointers
-extern void scope_check_stmt(stmt_t stmt);
+// and record the lexical address of each use in the AST
+extern void scope_check_stmt(stmt_t *stmt);
 
-extern void scope_check_binary_op_expr(binary_op_expr_t exp);
+extern void scope_check_binary_op_expr(binary_op_expr_t *exp);
 
 // Add a declaration of the name id.name with the type t
 // to the current scope's symbol table,
 // producing an error if this would be a duplicate declaration
-extern void scope_check_declare_ident(ident_t id, AST_type vt, id_kind kind);
+extern void scope_check_declare_ident(const ident_t *id, AST_type vt,
+                                      id_kind kind);
 
 // check the statement to make sure that
 // all idenfifiers referenced in it have been declared
 // (if not, then produce an error)
-// Return the modified AST with id_use pointers
-extern void scope_check_assignStmt(assign_stmt_t stmt);
+// and record the lexical address of each use in the AST
+extern void scope_check_assignStmt(assign_stmt_t *stmt);
 
 // check the statement to make sure that
 // all idenfifiers referenced in it have been declared
 // (if not, then produce an error)
-// Return the modified AST with id_use pointers
-extern void scope_check_callStmt(call_stmt_t stmt);
+// and record the lexical address of each use in the AST
+extern void scope_check_callStmt(call_stmt_t *stmt);
 
-extern void scope_check_whileStmt(while_stmt_t stmt);
+extern void scope_check_whileStmt(while_stmt_t *stmt);
 
 
 
 // check the statement to make sure that
 // all idenfifiers referenced in it have been declared
 // (if not, then produce an error)
-// Return the modified AST with id_use pointers
-extern void scope_check_ifStmt(if_stmt_t stmt);
+// and record the lexical address of each use in the AST
+extern void scope_check_ifStmt(if_stmt_t *stmt);
 
 // check the statement to make sure that
 // all idenfifiers referenced in it have been declared
 // (if not, then produce an error)
-// Return the modified AST with id_use pointers
-extern void scope_check_readStmt(read_stmt_t stmt);
+// and record the lexical address of each use in the AST
+extern void scope_check_readStmt(read_stmt_t *stmt);
 
 // check the statement to make sure that
 // all idenfifiers referenced in it have been declared
 // (if not, then produce an error)
-// Return the modified AST with id_use pointers
+// and record the lexical address of each use in the AST
 
 
-extern void scope_check_printStmt(print_stmt_t stmt);
+extern void scope_check_printStmt(print_stmt_t *stmt);
 
 
-extern void scope_check_blockStmt(block_stmt_t stmt);
+extern void scope_check_blockStmt(block_stmt_t *stmt);
 
 
 // check the expresion to make sure that
 // all idenfifiers referenced in it have been declared
 // (if not, then produce an error)
-// Return the modified AST with id_use pointers
-extern void scope_check_expr(expr_t exp);
+// and record the lexical address of each use in the AST
+extern void scope_check_expr(expr_t *exp);
 
 // check the expression (exp) to make sure that
 // all idenfifiers referenced in it have been declared
 // (if not, then produce an error)
-// Return the modified AST with id_use pointers
-extern void scope_check_binary_op_expr(binary_op_expr_t exp);
+// and record the lexical address of each use in the AST
+extern void scope_check_binary_op_expr(binary_op_expr_t *exp);
 
 // check the identifier (id) to make sure that
 // all it has been declared (if not, then produce an error)
-// Return the modified AST with id_use pointers
-extern void scope_check_ident_expr(ident_t id);
+// and record the lexical address of each use in the AST
+extern void scope_check_ident_expr(ident_t *id);
 
 // check that the given name has been declared,
 // if so, then return an id_use (containing the attributes) for that name,
-// otherwise, produce an error using the file_location (floc) given.
-// Return the modified AST with id_use pointers
-extern id_use *scope_check_ident_declared(file_location floc, const char *name);
+// otherwise, produce an error using the file_location (floc) given
+// (and return an id_use with NULL attrs, if the checking goes on).
+extern id_use scope_check_ident_declared(file_location floc, const char *name);
+
+// Build the symbol table for the flat AST fa
+// and check it, just as scope_check_program checks a pointer AST
+// (recording the lexical address of each use of a name in fa's idents)
+extern void scope_check_flat_program(flat_ast_t *fa);
 
 #endif
\ No newline at end of file
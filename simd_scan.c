@@ -0,0 +1,161 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "simd_scan.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+// Is c one of the ignored space characters [ \t\v\f\r]?
+static inline bool is_space(unsigned char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r' && c != '\n');
+}
+
+// Is c a letter or digit?
+static inline bool is_ident_char(unsigned char c)
+{
+    return (unsigned char) ((c | 0x20) - 'a') < 26
+	|| (unsigned char) (c - '0') < 10;
+}
+
+// The versions of the functions that look at one character at a time
+
+static const char *skip_spaces_scalar(const char *p)
+{
+    while (is_space((unsigned char) *p)) {
+	p++;
+    }
+    return p;
+}
+
+static const char *skip_ident_chars_scalar(const char *p)
+{
+    while (is_ident_char((unsigned char) *p)) {
+	p++;
+    }
+    return p;
+}
+
+#ifdef SIMD_SCAN_X86
+
+// In the vector versions below, a byte x is in the range lo..lo+n
+// exactly when (x - lo) (mod 256) is at most n,
+// which is tested as min(x - lo, n) == x - lo using unsigned bytes.
+
+// The SSE2 versions, which look at 16 characters at a time
+
+__attribute__((target("sse2")))
+static inline __m128i in_range_sse2(__m128i x, char lo, char n)
+{
+    __m128i d = _mm_sub_epi8(x, _mm_set1_epi8(lo));
+    return _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(n)), d);
+}
+
+__attribute__((target("sse2")))
+static const char *skip_spaces_sse2(const char *p)
+{
+    for (;;) {
+	__m128i x = _mm_loadu_si128((const __m128i *) p);
+	__m128i spaces = _mm_or_si128(
+	    _mm_cmpeq_epi8(x, _mm_set1_epi8(' ')),
+	    _mm_andnot_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('\n')),
+			     in_range_sse2(x, '\t', '\r' - '\t')));
+	unsigned int mask = (unsigned int) _mm_movemask_epi8(spaces);
+	if (mask != 0xFFFF) {
+	    return p + __builtin_ctz(~mask);
+	}
+	p += 16;
+    }
+}
+
+__attribute__((target("sse2")))
+static const char *skip_ident_chars_sse2(const char *p)
+{
+    for (;;) {
+	__m128i x = _mm_loadu_si128((const __m128i *) p);
+	__m128i letters = in_range_sse2(_mm_or_si128(x, _mm_set1_epi8(0x20)),
+					'a', 'z' - 'a');
+	__m128i digits = in_range_sse2(x, '0', '9' - '0');
+	unsigned int mask =
+	    (unsigned int) _mm_movemask_epi8(_mm_or_si128(letters, digits));
+	if (mask != 0xFFFF) {
+	    return p + __builtin_ctz(~mask);
+	}
+	p += 16;
+    }
+}
+
+// The AVX2 versions, which look at 32 characters at a time
+
+__attribute__((target("avx2")))
+static inline __m256i in_range_avx2(__m256i x, char lo, char n)
+{
+    __m256i d = _mm256_sub_epi8(x, _mm256_set1_epi8(lo));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(n)), d);
+}
+
+__attribute__((target("avx2")))
+static const char *skip_spaces_avx2(const char *p)
+{
+    for (;;) {
+	__m256i x = _mm256_loadu_si256((const __m256i *) p);
+	__m256i spaces = _mm256_or_si256(
+	    _mm256_cmpeq_epi8(x, _mm256_set1_epi8(' ')),
+	    _mm256_andnot_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('\n')),
+				in_range_avx2(x, '\t', '\r' - '\t')));
+	unsigned int mask = (unsigned int) _mm256_movemask_epi8(spaces);
+	if (mask != 0xFFFFFFFFu) {
+	    return p + __builtin_ctz(~mask);
+	}
+	p += 32;
+    }
+}
+
+__attribute__((target("avx2")))
+static const char *skip_ident_chars_avx2(const char *p)
+{
+    for (;;) {
+	__m256i x = _mm256_loadu_si256((const __m256i *) p);
+	__m256i letters =
+	    in_range_avx2(_mm256_or_si256(x, _mm256_set1_epi8(0x20)),
+			  'a', 'z' - 'a');
+	__m256i digits = in_range_avx2(x, '0', '9' - '0');
+	unsigned int mask = (unsigned int)
+	    _mm256_movemask_epi8(_mm256_or_si256(letters, digits));
+	if (mask != 0xFFFFFFFFu) {
+	    return p + __builtin_ctz(~mask);
+	}
+	p += 32;
+    }
+}
+
+#endif
+
+const char *(*simd_skip_spaces)(const char *p) = skip_spaces_scalar;
+const char *(*simd_skip_ident_chars)(const char *p) = skip_ident_chars_scalar;
+
+// Choose the fastest versions of the functions for this CPU
+// (limited by the environment variable SIMD_SCAN, if it is set)
+void simd_scan_init()
+{
+    const char *limit = getenv("SIMD_SCAN");
+    if (limit != NULL && strcmp(limit, "scalar") == 0) {
+	simd_skip_spaces = skip_spaces_scalar;
+	simd_skip_ident_chars = skip_ident_chars_scalar;
+	return;
+    }
+#ifdef SIMD_SCAN_X86
+    bool sse2_only = (limit != NULL && strcmp(limit, "sse2") == 0);
+    __builtin_cpu_init();
+    if (!sse2_only && __builtin_cpu_supports("avx2")) {
+	simd_skip_spaces = skip_spaces_avx2;
+	simd_skip_ident_chars = skip_ident_chars_avx2;
+    } else if (__builtin_cpu_supports("sse2")) {
+	simd_skip_spaces = skip_spaces_sse2;
+	simd_skip_ident_chars = skip_ident_chars_sse2;
+    }
+#endif
+}
@@ -0,0 +1,33 @@
+#ifndef _SIMD_SCAN_H
+#define _SIMD_SCAN_H
+
+// The simd_scan module finds the end of a run of characters of one kind,
+// looking at 16 or 32 characters at a time when the CPU allows it
+// (using AVX2 or SSE2 on x86, chosen when simd_scan_init is called),
+// and one at a time otherwise.
+
+// Number of readable bytes that must follow the text being scanned.
+// The scanning functions may read (but ignore) this many bytes
+// past the end of the run, so the text must be followed by at least
+// SIMD_SCAN_PADDING bytes that do not belong to the run (e.g., nulls).
+#define SIMD_SCAN_PADDING 32
+
+// Choose the fastest versions of the functions below for this CPU
+// (until this is called, they look at one character at a time).
+// Setting the environment variable SIMD_SCAN to "scalar" or "sse2"
+// limits the choice to those versions (e.g., for testing).
+extern void simd_scan_init();
+
+// Requires: p is followed by SIMD_SCAN_PADDING characters
+//           that are not ignored (see above)
+// Return a pointer to the first character at or after p
+// that is not an ignored space character (one of [ \t\v\f\r])
+extern const char *(*simd_skip_spaces)(const char *p);
+
+// Requires: p is followed by SIMD_SCAN_PADDING characters
+//           that are not letters or digits (see above)
+// Return a pointer to the first character at or after p
+// that is not a letter or digit
+extern const char *(*simd_skip_ident_chars)(const char *p);
+
+#endif
@@ -2,6 +2,7 @@
 
 %code top {
 #include <stdio.h>
+#include "utilities.h"
 }
 
 %code requires {
@@ -114,6 +115,11 @@ block_t progast;
 
  /* Set the program's ast to be t */
 extern void setProgAST(block_t t);
+
+ /* Should parsing go on after the syntax error just reported?
+    (The AST is not used once there has been a syntax error,
+    so the error rules below just make placeholders.) */
+static bool continue_after_syntax_error();
 }
 
 
@@ -133,6 +139,8 @@ constDecls : constDecls constDecl { $$ = ast_const_decls($1, $2); }
            ;
 
 constDecl : constsym constDefList semisym { $$ = ast_const_decl($2); }
+          | constsym error { if (!continue_after_syntax_error()) { YYABORT; } }
+            semisym { $$ = (const_decl_t) { .type_tag = const_decl_ast }; }
           ;
 
 constDefList : constDef { $$ = ast_const_def_list_singleton($1); } 
@@ -147,6 +155,8 @@ varDecls : varDecls varDecl { $$ = ast_var_decls($1, $2); }
          ;
         
 varDecl : varsym identList semisym { $$ = ast_var_decl($2); }
+        | varsym error { if (!continue_after_syntax_error()) { YYABORT; } }
+          semisym { $$ = (var_decl_t) { .type_tag = var_decl_ast }; }
         ; 
 
 identList : identsym { $$ = ast_ident_list_singleton($1); }
@@ -162,10 +172,7 @@ procDecl : procsym identsym block ";" { $$ = ast_proc_decl($2, $3); };
 stmts : empty { $$ = ast_stmts_empty($1); } 
       | stmtList { $$ = ast_stmts($1); }
       ;
-empty : %empty { file_location *file_loc
-	     = file_location_make(lexer_filename(), lexer_line());
-          $$ = ast_empty(file_loc);
-	  }
+empty : %empty { $$ = ast_empty(lexer_location()); }
       ;
 stmtList : stmt { $$ = ast_stmt_list_singleton($1); }
           | stmtList semisym stmt { $$ = ast_stmt_list($1, $3); }
@@ -178,6 +185,8 @@ stmt: assignStmt { $$ = ast_stmt_assign($1); }
     | readStmt { $$ = ast_stmt_read($1); }
     | printStmt { $$ = ast_stmt_print($1); }
     | blockStmt { $$ = ast_stmt_block($1); }
+    | error { if (!continue_after_syntax_error()) { YYABORT; }
+              $$ = (stmt_t) { .type_tag = stmt_ast }; }
     ;
 
 assignStmt : identsym becomessym expr { $$ = ast_assign_stmt($1, $3); }
@@ -232,4 +241,12 @@ sign : plussym | minussym
 %%
 
 // Set the program's ast to be ast
-void setProgAST(block_t ast) { progast = ast; }
\ No newline at end of file
+void setProgAST(block_t ast) { progast = ast; }
+
+// Should parsing go on after the syntax error just reported?
+// Only if the number of errors is below the limit (see set_error_limit).
+static bool continue_after_syntax_error()
+{
+    unsigned int limit = get_error_limit();
+    return limit == 0 || (unsigned int) yynerrs < limit;
+}
\ No newline at end of file
@@ -0,0 +1,276 @@
+// Generator of synthetic (but valid) SPL programs, for benchmarking.
+// The size and shape of the program are set by the options
+// (see usage below); the program is printed on standard output.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+// Amount of spaces to indent per nesting level (as in the unparser)
+#define SPACES_PER_LEVEL 2
+
+// Most definitions or names in one const or var declaration
+#define MAX_PER_DECL 8
+
+// The parameters of the program to generate
+static unsigned int num_decls = 10;   // consts (and vars) per block
+static unsigned int num_stmts = 10;   // statements per block
+static unsigned int expr_depth = 3;   // nesting of parentheses in exprs
+static unsigned int nesting = 2;      // depth of nested block statements
+static unsigned int num_procs = 2;    // procedures in the outermost block
+static unsigned int num_comments = 0; // comment lines before each stmt
+
+// The number of procedures declared so far
+// (only these can be called in the statements being printed)
+static unsigned int procs_declared = 0;
+
+// The deepest level whose block declares constants that are visible.
+// The scope checker only declares the constants of the program
+// and of procedures (not of block statements),
+// so this is 1 in a procedure and 0 elsewhere.
+static unsigned int const_level = 0;
+
+// State of the pseudo-random number generator (xorshift64)
+static uint64_t rng_state = 88172645463325252ULL;
+
+/* Print a usage message on stderr
+   and exit with failure. */
+static void usage(const char *cmdname)
+{
+    fprintf(stderr,
+	    "Usage: %s [-d decls] [-s stmts] [-e exprdepth] [-n nesting]"
+	    " [-p procs] [-c comments] [-r seed]\n",
+	    cmdname);
+    exit(EXIT_FAILURE);
+}
+
+// Return the value of num, which must be a decimal number,
+// otherwise print a usage message and exit
+static unsigned int count_arg(const char *cmdname, const char *num)
+{
+    char *end;
+    long n = strtol(num, &end, 10);
+    if (*num == '\0' || *end != '\0' || n < 0) {
+	usage(cmdname);
+    }
+    return (unsigned int) n;
+}
+
+// Return a pseudo-random number less than n (which must be positive)
+static unsigned int rnd(unsigned int n)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (unsigned int) (rng_state % n);
+}
+
+// Print SPACES_PER_LEVEL * level spaces
+static void indent(unsigned int level)
+{
+    printf("%*s", (int) (SPACES_PER_LEVEL * level), "");
+}
+
+// Print a name declared in a block at a level at most level
+// (a variable if var_only is true, otherwise a variable or constant)
+static void print_name(unsigned int level, int var_only)
+{
+    unsigned int i = rnd(num_decls);
+    if (var_only || rnd(2) == 0) {
+	printf("v%ux%u", rnd(level + 1), i);
+    } else {
+	unsigned int top = (level < const_level) ? level : const_level;
+	printf("c%ux%u", rnd(top + 1), i);
+    }
+}
+
+// Print a factor: a name, if there are any, or a number
+static void print_factor(unsigned int level)
+{
+    if (num_decls > 0 && rnd(3) != 0) {
+	print_name(level, 0);
+    } else {
+	printf("%u", rnd(1000));
+    }
+}
+
+// Print an expression in which parentheses nest depth deep
+static void print_expr(unsigned int level, unsigned int depth)
+{
+    static const char *ops[] = { "+", "-", "*", "/" };
+    print_factor(level);
+    if (depth > 0) {
+	printf(" %s (", ops[rnd(4)]);
+	print_expr(level, depth - 1);
+	printf(")");
+    }
+}
+
+// Print a condition
+static void print_condition(unsigned int level)
+{
+    static const char *rel_ops[] = { "==", "!=", "<", "<=", ">", ">=" };
+    if (rnd(8) == 0) {
+	printf("divisible ");
+	print_expr(level, expr_depth / 2);
+	printf(" by ");
+	print_factor(level);
+    } else {
+	print_expr(level, expr_depth / 2);
+	printf(" %s ", rel_ops[rnd(6)]);
+	print_factor(level);
+    }
+}
+
+// Print a statement without nested statements, for a block at level
+static void print_simple_stmt(unsigned int level)
+{
+    unsigned int kind = (num_decls == 0) ? 0 : rnd(8);
+    if (kind == 0 || kind == 1) {
+	printf("print ");
+	print_expr(level, expr_depth);
+    } else if (kind == 2) {
+	printf("read ");
+	print_name(level, 1);
+    } else if (kind == 3 && procs_declared > 0) {
+	printf("call p%u", rnd(procs_declared));
+    } else {
+	print_name(level, 1);
+	printf(" := ");
+	print_expr(level, expr_depth);
+    }
+}
+
+// Print a statement for a block at level, indented by indent_level
+static void print_stmt(unsigned int level, unsigned int indent_level)
+{
+    for (unsigned int i = 0; i < num_comments; i++) {
+	indent(indent_level);
+	printf("%% comment line %u of this statement\n", i);
+    }
+    indent(indent_level);
+    unsigned int kind = rnd(8);
+    if (kind == 0) {
+	printf("if ");
+	print_condition(level);
+	printf(" then ");
+	print_simple_stmt(level);
+	printf(" else ");
+	print_simple_stmt(level);
+	printf(" end");
+    } else if (kind == 1) {
+	printf("while ");
+	print_condition(level);
+	printf(" do ");
+	print_simple_stmt(level);
+	printf(" end");
+    } else {
+	print_simple_stmt(level);
+    }
+}
+
+static void print_block(unsigned int level, unsigned int indent_level,
+			int with_consts);
+
+// Print the declarations named prefix (with values if is_const)
+// for a block at level, indented by indent_level
+static void print_decls(const char *keyword, char prefix, int is_const,
+			unsigned int level, unsigned int indent_level)
+{
+    for (unsigned int i = 0; i < num_decls; i++) {
+	if (i % MAX_PER_DECL == 0) {
+	    indent(indent_level);
+	    printf("%s", keyword);
+	} else {
+	    printf(",");
+	}
+	printf(" %c%ux%u", prefix, level, i);
+	if (is_const) {
+	    printf(" = %u", rnd(100000));
+	}
+	if (i % MAX_PER_DECL == MAX_PER_DECL - 1 || i == num_decls - 1) {
+	    printf(";\n");
+	}
+    }
+}
+
+// Print a block at level (the number of blocks it is nested in),
+// indented by indent_level, declaring constants if with_consts is true
+static void print_block(unsigned int level, unsigned int indent_level,
+			int with_consts)
+{
+    indent(indent_level);
+    printf("begin\n");
+    if (with_consts) {
+	print_decls("const", 'c', 1, level, indent_level + 1);
+    }
+    print_decls("var", 'v', 0, level, indent_level + 1);
+    if (level == 0) {
+	for (unsigned int p = 0; p < num_procs; p++) {
+	    indent(indent_level + 1);
+	    printf("proc p%u\n", p);
+	    procs_declared = p + 1;
+	    const_level = 1;
+	    print_block(level + 1, indent_level + 1, 1);
+	    const_level = 0;
+	    printf(";\n");
+	}
+    }
+    unsigned int count = num_stmts + (level < nesting ? 1 : 0);
+    for (unsigned int i = 0; i < count; i++) {
+	if (i == num_stmts) {
+	    // the last statement is a nested block
+	    print_block(level + 1, indent_level + 1, 0);
+	} else {
+	    print_stmt(level, indent_level + 1);
+	}
+	printf("%s\n", (i + 1 < count) ? ";" : "");
+    }
+    indent(indent_level);
+    printf("end");
+}
+
+int main(int argc, char *argv[])
+{
+    const char *cmdname = argv[0];
+    for (int i = 1; i < argc; i++) {
+	if (argv[i][0] != '-' || strlen(argv[i]) != 2 || i + 1 >= argc) {
+	    usage(cmdname);
+	}
+	unsigned int n = count_arg(cmdname, argv[i + 1]);
+	switch (argv[i][1]) {
+	case 'd':
+	    num_decls = n;
+	    break;
+	case 's':
+	    num_stmts = n;
+	    break;
+	case 'e':
+	    expr_depth = n;
+	    break;
+	case 'n':
+	    nesting = n;
+	    break;
+	case 'p':
+	    num_procs = n;
+	    break;
+	case 'c':
+	    num_comments = n;
+	    break;
+	case 'r':
+	    // xorshift needs a nonzero state
+	    rng_state = (uint64_t) n * 2654435761ULL + 1;
+	    break;
+	default:
+	    usage(cmdname);
+	    break;
+	}
+	i++;
+    }
+    printf("%% generated by %s with -d %u -s %u -e %u -n %u -p %u -c %u\n",
+	   "spl_gen", num_decls, num_stmts, expr_depth, nesting,
+	   num_procs, num_comments);
+    print_block(0, 0, 1);
+    printf(".\n");
+    return EXIT_SUCCESS;
+}
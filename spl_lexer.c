@@ -543,10 +543,18 @@ char *yytext;
 #include <stdbool.h>
 #include <assert.h>
 #include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include "ast.h"
 #include "parser_types.h"
 #include "utilities.h"
 #include "lexer.h"
+#include "intern.h"
+#include "arena.h"
+#include "stats.h"
+#include "number_literal.h"
 
  /* Tokens generated by Bison */
 #include "spl.tab.h"
@@ -561,6 +569,17 @@ static char *input_filename;
 /* Have any errors been noted? */
 static bool errors_noted;
 
+/* The number of the input file in the table of file locations */
+static unsigned int input_file_id;
+
+/* The offsets in the input of the current token
+   and of the character after it */
+static unsigned int token_offset;
+static unsigned int input_offset;
+
+/* Track the offset of each token as it is matched */
+#define YY_USER_ACTION { token_offset = input_offset; input_offset += yyleng; }
+
 /* The value of a token */
 extern YYSTYPE yylval;
 
@@ -573,42 +592,43 @@ extern FILE *yyin;
 
 #undef yywrap   /* sometimes a macro by default */
 
-// apparently strdup is not declared in <string.h>
-extern char *strdup(const char *s);
+/* The scanner generated by flex is lexer_scan;
+   yylex (below) calls it and counts the tokens */
+#define YY_DECL static int lexer_scan(YYSTYPE *yylval_param)
 
 // set the lexer's value for a token in yylval as an AST
 static void tok2ast(int code) {
     AST t;
-    t.token.file_loc = file_location_make(input_filename, yylineno);
+    t.token.file_loc = lexer_location();
     t.token.type_tag = token_ast;
     t.token.code = code;
-    t.token.text = strdup(yytext);
+    // the spellings of tokens are few, so share one copy of each
+    t.token.text = intern_string_n(yytext, yyleng);
     yylval = t;
 }
 
-static void ident2ast(const char *name) {
+static void ident2ast(const char *name, size_t len) {
     AST t;
     assert(input_filename != NULL);
-    t.ident.file_loc = file_location_make(input_filename, yylineno);
-    t.ident.type_tag = ident_ast;
-    t.ident.name = strdup(name);
+    // (ast_ident also marks the name's lexical address as unresolved)
+    t.ident = ast_ident(lexer_location(), intern_string_n(name, len));
     yylval = t;
 }
 
-static void number2ast(unsigned int val)
+static void number2ast(word_type val)
 {
     AST t;
-    t.number.file_loc = file_location_make(input_filename, yylineno);
+    t.number.file_loc = lexer_location();
     t.number.type_tag = number_ast;
-    t.number.text = strdup(yytext);
+    t.number.text = arena_strndup(yytext, yyleng);
     t.number.value = val;
     yylval = t;
 }
 
-#line 609 "spl_lexer.c"
-#line 80 "spl_lexer.l"
+#line 629 "spl_lexer.c"
+#line 99 "spl_lexer.l"
  /* you can add actual definitions below, before the %% */
-#line 612 "spl_lexer.c"
+#line 632 "spl_lexer.c"
 
 #define INITIAL 0
 
@@ -835,12 +855,12 @@ YY_DECL
 		}
 
 	{
-#line 94 "spl_lexer.l"
+#line 113 "spl_lexer.l"
 
 
  /* fill in the rules for your lexer below! */
 
-#line 844 "spl_lexer.c"
+#line 864 "spl_lexer.c"
 
 	while ( /*CONSTCOND*/1 )		/* loops until end-of-file is reached */
 		{
@@ -909,212 +929,196 @@ do_action:	/* This label is used only to access EOF actions. */
 
 case 1:
 YY_RULE_SETUP
-#line 98 "spl_lexer.l"
+#line 117 "spl_lexer.l"
 { ; } /* do nothing */
 	YY_BREAK
 case 2:
 YY_RULE_SETUP
-#line 99 "spl_lexer.l"
+#line 118 "spl_lexer.l"
 { ; } /* ignore comments */
 	YY_BREAK
 case 3:
 /* rule 3 can match eol */
 YY_RULE_SETUP
-#line 100 "spl_lexer.l"
-{ ; } /* ignore EOL */
+#line 119 "spl_lexer.l"
+{ file_location_note_line_start(input_file_id,
+                                                input_offset); }
 	YY_BREAK
 case 4:
 YY_RULE_SETUP
-#line 102 "spl_lexer.l"
-{ unsigned long lval;
-                  int ssf_ret;
-                  ssf_ret = sscanf(yytext, "%lu", &lval);
-                  if (ssf_ret != 1) {
-                      bail_with_error("Number (%s) couldn't be read by lexer!",
-				      yytext);
-                  }
-                  if (INT_MAX < lval ) {
-                      char msgbuf[512];
-                      if (strlen(yytext) >= 300) {
-                          snprintf(msgbuf, 327, "Number (%s...) is too large!",
-				  yytext);
-                      } else {
-                          sprintf(msgbuf, "Number (%s) is too large!", yytext);
-                      }
-                      yyerror(lexer_filename(), msgbuf);
-                  }
-                  number2ast((int) lval);
-                  return numbersym; 
+#line 122 "spl_lexer.l"
+{ number2ast(number_literal_value(yytext, yyleng));
+                  return numbersym;
                 }
 	YY_BREAK
 case 5:
 YY_RULE_SETUP
-#line 123 "spl_lexer.l"
+#line 126 "spl_lexer.l"
 { tok2ast(plussym); return plussym; }
 	YY_BREAK
 case 6:
 YY_RULE_SETUP
-#line 124 "spl_lexer.l"
+#line 127 "spl_lexer.l"
 { tok2ast(minussym); return minussym; }
 	YY_BREAK
 case 7:
 YY_RULE_SETUP
-#line 125 "spl_lexer.l"
+#line 128 "spl_lexer.l"
 { tok2ast(multsym); return multsym; }
 	YY_BREAK
 case 8:
 YY_RULE_SETUP
-#line 126 "spl_lexer.l"
+#line 129 "spl_lexer.l"
 { tok2ast(divsym); return divsym; }  
 	YY_BREAK
 case 9:
 YY_RULE_SETUP
-#line 128 "spl_lexer.l"
+#line 131 "spl_lexer.l"
 { return periodsym; }
 	YY_BREAK
 case 10:
 YY_RULE_SETUP
-#line 129 "spl_lexer.l"
+#line 132 "spl_lexer.l"
 { return semisym; }
 	YY_BREAK
 case 11:
 YY_RULE_SETUP
-#line 130 "spl_lexer.l"
+#line 133 "spl_lexer.l"
 { return commasym; }
 	YY_BREAK
 case 12:
 YY_RULE_SETUP
-#line 131 "spl_lexer.l"
+#line 134 "spl_lexer.l"
 { return becomessym; }
 	YY_BREAK
 case 13:
 YY_RULE_SETUP
-#line 132 "spl_lexer.l"
+#line 135 "spl_lexer.l"
 { tok2ast(eqsym); return eqeqsym; }
 	YY_BREAK
 case 14:
 YY_RULE_SETUP
-#line 133 "spl_lexer.l"
+#line 136 "spl_lexer.l"
 { tok2ast(eqsym); return eqsym; }
 	YY_BREAK
 case 15:
 YY_RULE_SETUP
-#line 134 "spl_lexer.l"
+#line 137 "spl_lexer.l"
 { tok2ast(neqsym); return neqsym; }
 	YY_BREAK
 case 16:
 YY_RULE_SETUP
-#line 135 "spl_lexer.l"
+#line 138 "spl_lexer.l"
 { tok2ast(leqsym); return leqsym; }
 	YY_BREAK
 case 17:
 YY_RULE_SETUP
-#line 136 "spl_lexer.l"
+#line 139 "spl_lexer.l"
 { tok2ast(geqsym); return geqsym; }
 	YY_BREAK
 case 18:
 YY_RULE_SETUP
-#line 137 "spl_lexer.l"
+#line 140 "spl_lexer.l"
 { tok2ast(gtsym); return gtsym; }
 	YY_BREAK
 case 19:
 YY_RULE_SETUP
-#line 138 "spl_lexer.l"
+#line 141 "spl_lexer.l"
 { tok2ast(ltsym); return ltsym; }
 	YY_BREAK
 case 20:
 YY_RULE_SETUP
-#line 139 "spl_lexer.l"
+#line 142 "spl_lexer.l"
 { tok2ast(lparensym); return lparensym; }
 	YY_BREAK
 case 21:
 YY_RULE_SETUP
-#line 140 "spl_lexer.l"
+#line 143 "spl_lexer.l"
 { tok2ast(rparensym); return rparensym; }
 	YY_BREAK
 case 22:
 YY_RULE_SETUP
-#line 142 "spl_lexer.l"
+#line 145 "spl_lexer.l"
 { tok2ast(constsym); return constsym; }
 	YY_BREAK
 case 23:
 YY_RULE_SETUP
-#line 143 "spl_lexer.l"
+#line 146 "spl_lexer.l"
 { tok2ast(varsym); return varsym; }
 	YY_BREAK
 case 24:
 YY_RULE_SETUP
-#line 144 "spl_lexer.l"
+#line 147 "spl_lexer.l"
 { tok2ast(procsym); return procsym; }
 	YY_BREAK
 case 25:
 YY_RULE_SETUP
-#line 145 "spl_lexer.l"
+#line 148 "spl_lexer.l"
 { tok2ast(callsym); return callsym; }
 	YY_BREAK
 case 26:
 YY_RULE_SETUP
-#line 146 "spl_lexer.l"
+#line 149 "spl_lexer.l"
 { tok2ast(beginsym); return beginsym; }
 	YY_BREAK
 case 27:
 YY_RULE_SETUP
-#line 147 "spl_lexer.l"
+#line 150 "spl_lexer.l"
 { tok2ast(endsym); return endsym; }
 	YY_BREAK
 case 28:
 YY_RULE_SETUP
-#line 148 "spl_lexer.l"
+#line 151 "spl_lexer.l"
 { tok2ast(ifsym); return ifsym; }
 	YY_BREAK
 case 29:
 YY_RULE_SETUP
-#line 149 "spl_lexer.l"
+#line 152 "spl_lexer.l"
 { tok2ast(thensym); return thensym; }
 	YY_BREAK
 case 30:
 YY_RULE_SETUP
-#line 150 "spl_lexer.l"
+#line 153 "spl_lexer.l"
 { tok2ast(elsesym); return elsesym; }
 	YY_BREAK
 case 31:
 YY_RULE_SETUP
-#line 151 "spl_lexer.l"
+#line 154 "spl_lexer.l"
 { tok2ast(whilesym); return whilesym; }
 	YY_BREAK
 case 32:
 YY_RULE_SETUP
-#line 152 "spl_lexer.l"
+#line 155 "spl_lexer.l"
 { tok2ast(dosym); return dosym; }
 	YY_BREAK
 case 33:
 YY_RULE_SETUP
-#line 153 "spl_lexer.l"
+#line 156 "spl_lexer.l"
 { tok2ast(readsym); return readsym; }
 	YY_BREAK
 case 34:
 YY_RULE_SETUP
-#line 154 "spl_lexer.l"
+#line 157 "spl_lexer.l"
 { tok2ast(printsym); return printsym; }
 	YY_BREAK
 case 35:
 YY_RULE_SETUP
-#line 155 "spl_lexer.l"
+#line 158 "spl_lexer.l"
 { tok2ast(divisiblesym); return divisiblesym; }
 	YY_BREAK
 case 36:
 YY_RULE_SETUP
-#line 156 "spl_lexer.l"
+#line 159 "spl_lexer.l"
 { tok2ast(bysym); return bysym; }
 	YY_BREAK
 case 37:
 YY_RULE_SETUP
-#line 158 "spl_lexer.l"
-{ ident2ast(yytext); return identsym; }
+#line 161 "spl_lexer.l"
+{ ident2ast(yytext, yyleng); return identsym; }
 	YY_BREAK
 case 38:
 YY_RULE_SETUP
-#line 160 "spl_lexer.l"
+#line 163 "spl_lexer.l"
 { char msgbuf[512];
       sprintf(msgbuf, "invalid character: '%c' ('\\0%o')", *yytext, *yytext);
       yyerror(lexer_filename(), msgbuf);
@@ -1125,7 +1129,7 @@ YY_RULE_SETUP
 #line 164 "spl_lexer.l"
 ECHO;
 	YY_BREAK
-#line 1129 "spl_lexer.c"
+#line 1133 "spl_lexer.c"
 case YY_STATE_EOF(INITIAL):
 	yyterminate();
 
@@ -2142,39 +2146,131 @@ void yyfree (void * ptr )
 
 #define YYTABLES_NAME "yytables"
 
-#line 164 "spl_lexer.l"
+#line 167 "spl_lexer.l"
 
 
  /* This code goes in the user code section of the spl_lexer.l file,
    following the last %% above. */
 
+// When the input file is memory mapped, the scanner works directly
+// on the mapping (which is private, as flex temporarily writes
+// null characters into its buffer).
+// mapped_input is NULL when the input is read using yyin.
+static char *mapped_input = NULL;
+static size_t mapped_length = 0;
+static YY_BUFFER_STATE mapped_buffer = NULL;
+
+// Try to memory map the file named fname and start scanning it in place.
+// Return true if that worked, and false if the file should be read
+// with stdio instead (e.g., if it is not a regular file or is empty).
+static bool lexer_map_file(const char *fname)
+{
+    int fd = open(fname, O_RDONLY);
+    if (fd < 0) {
+	return false;
+    }
+    struct stat sb;
+    if (fstat(fd, &sb) != 0 || !S_ISREG(sb.st_mode) || sb.st_size == 0) {
+	close(fd);
+	return false;
+    }
+    size_t size = (size_t) sb.st_size;
+    // flex needs two null characters after the input;
+    // these are the zero fill at the end of the file's last page,
+    // so the file's size must leave room for them on that page
+    size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    if (size % page == 0 || page - (size % page) < 2) {
+	close(fd);
+	return false;
+    }
+    void *addr = mmap(NULL, size + 2, PROT_READ | PROT_WRITE,
+		      MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+	return false;
+    }
+    mapped_input = (char *) addr;
+    mapped_length = size + 2;
+    mapped_buffer = yy_scan_buffer(mapped_input, mapped_length);
+    if (mapped_buffer == NULL) {
+	munmap(mapped_input, mapped_length);
+	mapped_input = NULL;
+	return false;
+    }
+    return true;
+}
+
+// Unmap or close the current input, if any
+static void lexer_close_input()
+{
+    if (mapped_input != NULL) {
+	yy_delete_buffer(mapped_buffer);
+	mapped_buffer = NULL;
+	if (munmap(mapped_input, mapped_length) != 0) {
+	    bail_with_error("Cannot unmap %s!", input_filename);
+	}
+	mapped_input = NULL;
+    }
+    if (yyin != NULL) {
+	int rc = fclose(yyin);
+	yyin = NULL;
+	if (rc == EOF) {
+	    bail_with_error("Cannot close %s!", input_filename);
+	}
+    }
+}
+
 // Requires: fname != NULL
 // Requires: fname is the name of a readable file
 // Initialize the lexer and start it reading
 // from the given file name
+// (the file is memory mapped if possible, otherwise it is read with stdio).
+// This may be called again for another file,
+// even if the previous file was not read to its end.
 void lexer_init(char *fname)
 {
+    // discard what is left of any previous input
+    lexer_close_input();
+    if (YY_CURRENT_BUFFER != NULL) {
+	yy_delete_buffer(YY_CURRENT_BUFFER);
+    }
+    yylineno = 1;
     errors_noted = false;
+    input_filename = fname;
+    input_file_id = file_location_add_file(fname);
+    token_offset = 0;
+    input_offset = 0;
+    if (lexer_map_file(fname)) {
+	yyin = NULL;
+	return;
+    }
     yyin = fopen(fname, "r");
     if (yyin == NULL) {
 	bail_with_error("Cannot open %s", fname);
     }
-    input_filename = fname;
+    yyrestart(yyin);
 }
 
-// Close the file yyin
+// Close the file yyin (or unmap the input)
 // and return 0 to indicate that there are no more files
 int yywrap() {
-    if (yyin != NULL) {
-	int rc = fclose(yyin);
-	if (rc == EOF) {
-	    bail_with_error("Cannot close %s!", input_filename);
-	}
-    }
+    lexer_close_input();
     input_filename = NULL;
     return 1;  /* no more input */
 }
 
+// Return the next token in the input (0 at the end),
+// counting it (and timing the scanner) for the statistics
+int yylex(YYSTYPE *yylval_param) {
+    stats_phase_start(stats_lex);
+    int t = lexer_scan(yylval_param);
+    stats_phase_end(stats_lex);
+    if (t != 0) {
+        stats_count_token();
+    }
+    return t;
+}
+
 // Return the name of the current input file
 const char *lexer_filename() {
     return input_filename;
@@ -2185,6 +2281,11 @@ unsigned int lexer_line() {
     return yylineno;
 }
 
+// Return the location of the start of the token most recently read
+file_location lexer_location() {
+    return file_location_make(input_file_id, token_offset);
+}
+
 /* Report an error to the user on stderr */
 void yyerror(const char *filename, const char *msg)
 {
@@ -0,0 +1,386 @@
+#define _POSIX_C_SOURCE 200809L  // for clock_gettime
+#include <stdio.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "stats.h"
+#include "utilities.h"
+
+// Names of the phases, in the order of stats_phase
+static const char *phase_names[num_stats_phases] = {
+    "lex", "parse", "flatten", "unparse", "check"
+};
+
+// Names of the AST types, in the order of AST_type
+static const char *ast_type_names[NUM_AST_TYPES] = {
+    "block", "const_decls", "const_decl", "const_def_list", "const_def",
+    "var_decls", "var_decl", "ident_list", "proc_decls", "proc_decl",
+    "stmts", "empty", "stmt_list", "stmt", "assign_stmt", "call_stmt",
+    "if_stmt", "while_stmt", "read_stmt", "print_stmt", "block_stmt",
+    "condition", "db_condition", "rel_op_condition", "expr",
+    "binary_op_expr", "negated_expr", "ident", "number", "token"
+};
+
+static bool enabled = false;
+static stats_t totals;
+
+// when the run started (i.e., when stats_enable was called)
+static struct timespec run_start;
+
+// when each phase last started, by the wall clock and in CPU time
+static struct timespec phase_start_wall[num_stats_phases];
+static struct timespec phase_start_cpu[num_stats_phases];
+
+// Return the number of seconds from start to end
+static double seconds_between(const struct timespec *start,
+			      const struct timespec *end)
+{
+    return (double) (end->tv_sec - start->tv_sec)
+	+ (double) (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Start timing the phases, and the run as a whole
+void stats_enable()
+{
+    enabled = true;
+    clock_gettime(CLOCK_MONOTONIC, &run_start);
+}
+
+// Has stats_enable been called?
+bool stats_enabled()
+{
+    return enabled;
+}
+
+// Note that the phase p is starting.
+// The lexer runs once per token, so only its wall time is measured,
+// as reading the CPU time clock is a system call.
+void stats_phase_start(stats_phase p)
+{
+    if (!enabled) {
+	return;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &phase_start_wall[p]);
+    if (p != stats_lex) {
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &phase_start_cpu[p]);
+    }
+}
+
+// Note that the phase p (started last by stats_phase_start) is over,
+// and add the time it took to the statistics
+void stats_phase_end(stats_phase p)
+{
+    if (!enabled) {
+	return;
+    }
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    totals.phase_time[p].wall += seconds_between(&phase_start_wall[p], &now);
+    if (p != stats_lex) {
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+	totals.phase_time[p].cpu += seconds_between(&phase_start_cpu[p], &now);
+    }
+}
+
+// Count a file being compiled
+void stats_count_file()
+{
+    totals.files++;
+}
+
+// Count a token returned by the lexer
+void stats_count_token()
+{
+    totals.tokens++;
+}
+
+// Count a scope entered in the symbol table
+void stats_count_scope()
+{
+    totals.scopes_entered++;
+}
+
+// Count a lookup of a name in the symbol table
+void stats_count_lookup()
+{
+    totals.symtab_lookups++;
+}
+
+// Count the bytes handed out by the arena for a file
+void stats_count_arena_bytes(size_t bytes)
+{
+    totals.arena_bytes += bytes;
+}
+
+// Count the bytes used by a flat AST
+void stats_count_flat_ast_bytes(size_t bytes)
+{
+    totals.flat_ast_bytes += bytes;
+}
+
+static void stats_count_block(const block_t *blk);
+static void stats_count_stmts(const stmts_t *stmts);
+
+// Count the nodes of the expression exp
+static void stats_count_expr(const expr_t *exp)
+{
+    totals.ast_nodes[expr_ast]++;
+    switch (exp->expr_kind) {
+    case expr_bin:
+	totals.ast_nodes[binary_op_expr_ast]++;
+	totals.ast_nodes[token_ast]++;
+	stats_count_expr(exp->data.binary.expr1);
+	stats_count_expr(exp->data.binary.expr2);
+	break;
+    case expr_negated:
+	totals.ast_nodes[negated_expr_ast]++;
+	stats_count_expr(exp->data.negated.expr);
+	break;
+    case expr_ident:
+	totals.ast_nodes[ident_ast]++;
+	break;
+    case expr_number:
+	totals.ast_nodes[number_ast]++;
+	break;
+    }
+}
+
+// Count the nodes of the condition cond
+static void stats_count_condition(const condition_t *cond)
+{
+    totals.ast_nodes[condition_ast]++;
+    switch (cond->cond_kind) {
+    case ck_db:
+	totals.ast_nodes[db_condition_ast]++;
+	stats_count_expr(&cond->data.db_cond.dividend);
+	stats_count_expr(&cond->data.db_cond.divisor);
+	break;
+    case ck_rel:
+	totals.ast_nodes[rel_op_condition_ast]++;
+	totals.ast_nodes[token_ast]++;
+	stats_count_expr(&cond->data.rel_op_cond.expr1);
+	stats_count_expr(&cond->data.rel_op_cond.expr2);
+	break;
+    }
+}
+
+// Count the nodes of the statement stmt
+static void stats_count_stmt(const stmt_t *stmt)
+{
+    totals.ast_nodes[stmt_ast]++;
+    switch (stmt->stmt_kind) {
+    case assign_stmt:
+	totals.ast_nodes[assign_stmt_ast]++;
+	stats_count_expr(stmt->data.assign_stmt.expr);
+	break;
+    case call_stmt:
+	totals.ast_nodes[call_stmt_ast]++;
+	break;
+    case if_stmt:
+	totals.ast_nodes[if_stmt_ast]++;
+	stats_count_condition(&stmt->data.if_stmt.condition);
+	stats_count_stmts(stmt->data.if_stmt.then_stmts);
+	if (stmt->data.if_stmt.else_stmts != NULL) {
+	    stats_count_stmts(stmt->data.if_stmt.else_stmts);
+	}
+	break;
+    case while_stmt:
+	totals.ast_nodes[while_stmt_ast]++;
+	stats_count_condition(&stmt->data.while_stmt.condition);
+	stats_count_stmts(stmt->data.while_stmt.body);
+	break;
+    case read_stmt:
+	totals.ast_nodes[read_stmt_ast]++;
+	break;
+    case print_stmt:
+	totals.ast_nodes[print_stmt_ast]++;
+	stats_count_expr(&stmt->data.print_stmt.expr);
+	break;
+    case block_stmt:
+	totals.ast_nodes[block_stmt_ast]++;
+	stats_count_block(stmt->data.block_stmt.block);
+	break;
+    }
+}
+
+// Count the nodes of the statements stmts
+static void stats_count_stmts(const stmts_t *stmts)
+{
+    totals.ast_nodes[stmts_ast]++;
+    if (stmts->stmts_kind == empty_stmts_e) {
+	return;
+    }
+    totals.ast_nodes[stmt_list_ast]++;
+    for (const stmt_t *s = stmts->stmt_list.start; s != NULL; s = s->next) {
+	stats_count_stmt(s);
+    }
+}
+
+// Count the nodes of the block blk
+static void stats_count_block(const block_t *blk)
+{
+    totals.ast_nodes[block_ast]++;
+    totals.ast_nodes[const_decls_ast]++;
+    for (const const_decl_t *cd = blk->const_decls.start; cd != NULL;
+	 cd = cd->next) {
+	totals.ast_nodes[const_decl_ast]++;
+	totals.ast_nodes[const_def_list_ast]++;
+	for (const const_def_t *def = cd->const_def_list.start; def != NULL;
+	     def = def->next) {
+	    totals.ast_nodes[const_def_ast]++;
+	    totals.ast_nodes[ident_ast]++;
+	    totals.ast_nodes[number_ast]++;
+	}
+    }
+    totals.ast_nodes[var_decls_ast]++;
+    for (const var_decl_t *vd = blk->var_decls.var_decls; vd != NULL;
+	 vd = vd->next) {
+	totals.ast_nodes[var_decl_ast]++;
+	totals.ast_nodes[ident_list_ast]++;
+	for (const ident_t *id = vd->ident_list.start; id != NULL;
+	     id = id->next) {
+	    totals.ast_nodes[ident_ast]++;
+	}
+    }
+    totals.ast_nodes[proc_decls_ast]++;
+    for (const proc_decl_t *pd = blk->proc_decls.proc_decls; pd != NULL;
+	 pd = pd->next) {
+	totals.ast_nodes[proc_decl_ast]++;
+	stats_count_block(pd->block);
+    }
+    stats_count_stmts(&blk->stmts);
+}
+
+// Count the nodes of the AST prog by their AST types
+void stats_count_ast(const block_t *prog)
+{
+    stats_count_block(prog);
+}
+
+// Put a copy of the statistics kept so far into *s
+void stats_get(stats_t *s)
+{
+    *s = totals;
+}
+
+// Add the statistics in *s to the statistics kept
+// (e.g., those gathered by another process)
+void stats_add(const stats_t *s)
+{
+    for (int p = 0; p < num_stats_phases; p++) {
+	totals.phase_time[p].wall += s->phase_time[p].wall;
+	totals.phase_time[p].cpu += s->phase_time[p].cpu;
+    }
+    totals.files += s->files;
+    totals.tokens += s->tokens;
+    for (int t = 0; t < NUM_AST_TYPES; t++) {
+	totals.ast_nodes[t] += s->ast_nodes[t];
+    }
+    totals.scopes_entered += s->scopes_entered;
+    totals.symtab_lookups += s->symtab_lookups;
+    totals.arena_bytes += s->arena_bytes;
+    totals.flat_ast_bytes += s->flat_ast_bytes;
+}
+
+// Return the number of seconds since stats_enable was called
+static double elapsed_seconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return seconds_between(&run_start, &now);
+}
+
+// Return the total number of AST nodes counted
+static unsigned long total_ast_nodes()
+{
+    unsigned long total = 0;
+    for (int t = 0; t < NUM_AST_TYPES; t++) {
+	total += totals.ast_nodes[t];
+    }
+    return total;
+}
+
+// Return the largest resident set size of this process
+// or of any of its (finished) children, in kilobytes
+static long peak_rss_kb()
+{
+    struct rusage self, children;
+    getrusage(RUSAGE_SELF, &self);
+    getrusage(RUSAGE_CHILDREN, &children);
+    return MAX(self.ru_maxrss, children.ru_maxrss);
+}
+
+// Print the statistics kept on out in human-readable form
+static void stats_print_text(FILE *out)
+{
+    fprintf(out, "Statistics for %lu file%s (%.6f s elapsed)\n",
+	    totals.files, (totals.files == 1 ? "" : "s"), elapsed_seconds());
+    fprintf(out, "  %-10s %12s %12s\n", "phase", "wall (s)", "cpu (s)");
+    for (int p = 0; p < num_stats_phases; p++) {
+	if (p == stats_lex) {
+	    fprintf(out, "  %-10s %12.6f %12s\n", phase_names[p],
+		    totals.phase_time[p].wall, "-");
+	} else {
+	    fprintf(out, "  %-10s %12.6f %12.6f\n", phase_names[p],
+		    totals.phase_time[p].wall, totals.phase_time[p].cpu);
+	}
+    }
+    double lex_wall = totals.phase_time[stats_lex].wall;
+    fprintf(out, "  (parse times include the lexer)\n");
+    fprintf(out, "tokens: %lu", totals.tokens);
+    if (lex_wall > 0) {
+	fprintf(out, " (%.0f tokens/s in the lexer)", totals.tokens / lex_wall);
+    }
+    fprintf(out, "\nAST nodes: %lu\n", total_ast_nodes());
+    for (int t = 0; t < NUM_AST_TYPES; t++) {
+	if (totals.ast_nodes[t] > 0) {
+	    fprintf(out, "  %-18s %lu\n", ast_type_names[t],
+		    totals.ast_nodes[t]);
+	}
+    }
+    fprintf(out, "scopes entered: %lu\n", totals.scopes_entered);
+    fprintf(out, "symtab lookups: %lu\n", totals.symtab_lookups);
+    fprintf(out, "arena bytes: %lu\n", totals.arena_bytes);
+    fprintf(out, "flat AST bytes: %lu\n", totals.flat_ast_bytes);
+    fprintf(out, "peak RSS: %ld KB\n", peak_rss_kb());
+}
+
+// Print the statistics kept on out as a JSON object
+static void stats_print_json(FILE *out)
+{
+    fprintf(out, "{\"files\": %lu, \"elapsed_s\": %.6f, \"phases\": {",
+	    totals.files, elapsed_seconds());
+    for (int p = 0; p < num_stats_phases; p++) {
+	fprintf(out, "%s\"%s\": {\"wall_s\": %.6f, \"cpu_s\": ",
+		(p > 0 ? ", " : ""), phase_names[p],
+		totals.phase_time[p].wall);
+	if (p == stats_lex) {
+	    fprintf(out, "null}");
+	} else {
+	    fprintf(out, "%.6f}", totals.phase_time[p].cpu);
+	}
+    }
+    fprintf(out, "}, \"tokens\": %lu, \"ast_nodes_total\": %lu,"
+	    " \"ast_nodes\": {", totals.tokens, total_ast_nodes());
+    for (int t = 0; t < NUM_AST_TYPES; t++) {
+	fprintf(out, "%s\"%s\": %lu", (t > 0 ? ", " : ""),
+		ast_type_names[t], totals.ast_nodes[t]);
+    }
+    fprintf(out, "}, \"scopes_entered\": %lu, \"symtab_lookups\": %lu,"
+	    " \"arena_bytes\": %lu, \"flat_ast_bytes\": %lu,"
+	    " \"peak_rss_kb\": %ld}\n",
+	    totals.scopes_entered, totals.symtab_lookups,
+	    totals.arena_bytes, totals.flat_ast_bytes, peak_rss_kb());
+}
+
+// Print the statistics kept (and the peak resident set size)
+// on out, in human-readable form
+// if json is false, and as a JSON object otherwise
+void stats_print(FILE *out, bool json)
+{
+    if (json) {
+	stats_print_json(out);
+    } else {
+	stats_print_text(out);
+    }
+    fflush(out);
+}
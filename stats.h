@@ -0,0 +1,99 @@
+#ifndef _STATS_H
+#define _STATS_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "ast.h"
+
+// The stats module keeps statistics about the work done in a run:
+// the time spent in each phase of compiling, and counts of the tokens,
+// AST nodes, scopes entered, symbol table lookups, and the bytes
+// taken by the arena and by flat ASTs.
+// The reports also give the peak resident set size of the run.
+// Counting is always done (it is cheap),
+// but the phases are only timed after stats_enable has been called.
+
+// The number of AST types (see ast.h)
+#define NUM_AST_TYPES (token_ast + 1)
+
+// The phases of compiling a file
+typedef enum {
+    stats_lex,      // the lexer (yylex), which is called by the parser
+    stats_parse,    // the parser, including the time spent in the lexer
+    stats_flatten,  // building a flat AST
+    stats_unparse,  // unparsing
+    stats_check,    // scope checking
+    num_stats_phases
+} stats_phase;
+
+// The time spent in a phase, in seconds
+typedef struct {
+    double wall;
+    double cpu;  // (only the wall time of the lexer is measured)
+} stats_time_t;
+
+// The statistics kept
+typedef struct {
+    stats_time_t phase_time[num_stats_phases];
+    unsigned long files;
+    unsigned long tokens;
+    unsigned long ast_nodes[NUM_AST_TYPES];
+    unsigned long scopes_entered;
+    unsigned long symtab_lookups;
+    // Only the storage made for each file's AST is counted:
+    // the arena (AST nodes and token texts) and flat ASTs.
+    // The mallocs of the symbol table's scopes and maps, the intern
+    // table, id_attrs, and line tables are not counted
+    // (the peak RSS in the reports covers those).
+    unsigned long arena_bytes;
+    unsigned long flat_ast_bytes;
+} stats_t;
+
+// Start timing the phases, and the run as a whole
+extern void stats_enable();
+
+// Has stats_enable been called?
+extern bool stats_enabled();
+
+// Note that the phase p is starting
+extern void stats_phase_start(stats_phase p);
+
+// Note that the phase p (started last by stats_phase_start) is over,
+// and add the time it took to the statistics
+extern void stats_phase_end(stats_phase p);
+
+// Count a file being compiled
+extern void stats_count_file();
+
+// Count a token returned by the lexer
+extern void stats_count_token();
+
+// Count a scope entered in the symbol table
+extern void stats_count_scope();
+
+// Count a lookup of a name in the symbol table
+extern void stats_count_lookup();
+
+// Count the bytes handed out by the arena for a file
+extern void stats_count_arena_bytes(size_t bytes);
+
+// Count the bytes used by a flat AST
+extern void stats_count_flat_ast_bytes(size_t bytes);
+
+// Count the nodes of the AST prog by their AST types
+extern void stats_count_ast(const block_t *prog);
+
+// Put a copy of the statistics kept so far into *s
+extern void stats_get(stats_t *s);
+
+// Add the statistics in *s to the statistics kept
+// (e.g., those gathered by another process)
+extern void stats_add(const stats_t *s);
+
+// Print the statistics kept (and the peak resident set size)
+// on out, in human-readable form
+// if json is false, and as a JSON object otherwise
+extern void stats_print(FILE *out, bool json);
+
+#endif
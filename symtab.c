@@ -1,25 +1,189 @@
 #include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 #include "symtab.h"
 #include "scope.h"
 #include "utilities.h"
+#include "stats.h"
 
 // The symbol table is a stack of scope (see the scope module).
+// Scopes above the top of the stack have been left, and are kept
+// (empty) so that entering a scope again can reuse their storage;
+// thus the number of scopes allocated is the maximum nesting depth.
+//
+// So that a lookup does not have to search each scope in turn,
+// the symbol table also keeps a single map from each name
+// to a stack of its bindings (innermost first).
+// Declaring a name pushes a binding, leaving a scope pops its bindings,
+// and a lookup is one hash probe for the innermost binding.
 
 // index of the top of the stack of scopes
 static int symtab_top_idx = -1;
 
-// the symbol table itself
-static scope_t *symtab[MAX_NESTING];
+// Initial number of scopes the stack has room for
+#define INITIAL_SYMTAB_CAPACITY 16
+
+// the symbol table itself, with room for symtab_capacity scopes
+// (slots that have never been used are NULL);
+// it grows geometrically as needed, so there is no limit on nesting
+static scope_t **symtab = NULL;
+static unsigned int symtab_capacity = 0;
+
+// index of no binding
+#define NO_BINDING (-1)
+
+// A binding of a name in one of the scopes of the stack.
+// The bindings are kept in a stack, in the order they were made,
+// so the bindings of the current scope are always at the top.
+typedef struct {
+    const char *name;
+    id_attrs *attrs;
+    int level;    // index in symtab of the scope of this binding
+    int shadowed; // index of the binding of name this one hides (or NO_BINDING)
+} binding_t;
+
+// Initial number of bindings the stack of bindings has room for
+#define INITIAL_BINDINGS_CAPACITY 64
+
+// the stack of bindings, with room for bindings_capacity bindings
+static binding_t *bindings = NULL;
+static unsigned int num_bindings = 0;
+static unsigned int bindings_capacity = 0;
+
+// An entry in the map from names to their innermost binding
+// (name is NULL in an empty slot)
+typedef struct {
+    const char *name;
+    int innermost; // index in bindings (or NO_BINDING)
+} name_slot_t;
+
+// Initial number of slots in the map (a power of 2)
+#define INITIAL_NAMES_CAPACITY 64
+
+// the map from names to bindings, an open addressing hash table
+// with names_capacity slots (a power of 2), num_names of which are used
+// (names stay in the map when their bindings are popped)
+static name_slot_t *names = NULL;
+static unsigned int num_names = 0;
+static unsigned int names_capacity = 0;
+
+// Requires: names != NULL
+// Return (a pointer to) the slot for name in the map,
+// which is empty if name is not in the map
+static name_slot_t *symtab_name_slot(const char *name)
+{
+    unsigned int mask = names_capacity - 1;
+    unsigned int i = scope_hash(name) & mask;
+    while (names[i].name != NULL && names[i].name != name)
+    {
+        i = (i + 1) & mask;
+    }
+    return &names[i];
+}
+
+// Make sure that the map has room for one more name,
+// keeping its load factor at most 1/2.
+static void symtab_names_reserve()
+{
+    if (names != NULL && 2 * (num_names + 1) <= names_capacity)
+    {
+        return;
+    }
+    name_slot_t *old_names = names;
+    unsigned int old_cap = names_capacity;
+    names_capacity = (names == NULL) ? INITIAL_NAMES_CAPACITY : 2 * old_cap;
+    names = (name_slot_t *)calloc(names_capacity, sizeof(name_slot_t));
+    if (names == NULL)
+    {
+        bail_with_error("No space for the symbol table's map of names!");
+    }
+    for (unsigned int i = 0; i < old_cap; i++)
+    {
+        if (old_names[i].name != NULL)
+        {
+            *symtab_name_slot(old_names[i].name) = old_names[i];
+        }
+    }
+    free(old_names);
+}
+
+// Push a binding of name to attrs in the current scope
+// onto the stack of bindings, making it name's innermost binding
+static void symtab_push_binding(const char *name, id_attrs *attrs)
+{
+    if (num_bindings == bindings_capacity)
+    {
+        bindings_capacity = (bindings == NULL) ? INITIAL_BINDINGS_CAPACITY
+                                               : 2 * bindings_capacity;
+        bindings = (binding_t *)realloc(bindings,
+                                        bindings_capacity * sizeof(binding_t));
+        if (bindings == NULL)
+        {
+            bail_with_error("No space for the symbol table's bindings!");
+        }
+    }
+    symtab_names_reserve();
+    name_slot_t *slot = symtab_name_slot(name);
+    if (slot->name == NULL)
+    {
+        slot->name = name;
+        slot->innermost = NO_BINDING;
+        num_names++;
+    }
+    binding_t *b = &bindings[num_bindings];
+    b->name = name;
+    b->attrs = attrs;
+    b->level = symtab_top_idx;
+    b->shadowed = slot->innermost;
+    slot->innermost = num_bindings;
+    num_bindings++;
+}
+
+// Pop the bindings of the current scope off the stack of bindings,
+// so the bindings they hid become innermost again
+static void symtab_pop_bindings()
+{
+    while (num_bindings > 0 && bindings[num_bindings - 1].level == symtab_top_idx)
+    {
+        num_bindings--;
+        binding_t *b = &bindings[num_bindings];
+        symtab_name_slot(b->name)->innermost = b->shadowed;
+    }
+}
+
+// Return (a pointer to) the innermost binding of name,
+// or NULL if name is not bound
+static binding_t *symtab_innermost_binding(const char *name)
+{
+    stats_count_lookup();
+    if (names == NULL)
+    {
+        return NULL;
+    }
+    name_slot_t *slot = symtab_name_slot(name);
+    if (slot->name == NULL || slot->innermost == NO_BINDING)
+    {
+        return NULL;
+    }
+    return &bindings[slot->innermost];
+}
 
 // initialize the symbol table
 void symtab_initialize()
 {
-    // initialize the internal state
+    // initialize the internal state,
+    // emptying any scopes left from a previous use
     symtab_top_idx = -1;
-    for (int i = 0; i < MAX_NESTING; i++)
+    for (unsigned int i = 0; i < symtab_capacity && symtab[i] != NULL; i++)
+    {
+        scope_clear(symtab[i]);
+    }
+    num_bindings = 0;
+    if (names != NULL)
     {
-        symtab[i] = NULL;
+        memset(names, 0, names_capacity * sizeof(name_slot_t));
     }
+    num_names = 0;
 }
 
 // Return the number of scopes currently in the symbol table.
@@ -62,25 +226,25 @@ unsigned int symtab_current_nesting_level()
 }
 
 // Is the symbol table itself full
-// (i.e., is symtab_current_nesting_level() equal to MAX_NESTING-1)?
+// (The stack of scopes grows as needed, so this is always false.)
 bool symtab_full()
 {
-    return symtab_current_nesting_level() == MAX_NESTING - 1;
+    return false;
 }
 
 // Is the given name associated with some attributes?
 // (this looks back through all scopes).
 bool symtab_declared(const char *name)
 {
-    return symtab_lookup(name) != NULL;
+    return symtab_lookup(name).attrs != NULL;
 }
 
 // Is the given name associated with some attributes in the current scope?
 // (this only looks in the current scope).
 bool symtab_declared_in_current_scope(const char *name)
 {
-    id_attrs *attrs = scope_lookup(symtab[symtab_top_idx], name);
-    return attrs != NULL;
+    binding_t *b = symtab_innermost_binding(name);
+    return b != NULL && b->level == symtab_top_idx;
 }
 
 // Put the given name, which is to be declared with kind k,
@@ -88,8 +252,7 @@ bool symtab_declared_in_current_scope(const char *name)
 // into the current scope's symbol table at the offset scope_next_offset().
 static void add_ident(scope_t *s, const char *name, id_attrs *attrs)
 {
-    id_attrs *old_attrs = scope_lookup(s, name);
-    if (old_attrs != NULL)
+    if (symtab_declared_in_current_scope(name))
     {
         bail_with_prog_error(attrs->file_loc,
                              "symtab_insert called with an already declared variable\"%s\"!",
@@ -98,6 +261,7 @@ static void add_ident(scope_t *s, const char *name, id_attrs *attrs)
     else
     {
         scope_insert(s, name, attrs);
+        symtab_push_binding(name, attrs);
     }
 }
 
@@ -109,38 +273,67 @@ void symtab_insert(const char *name, id_attrs *attrs)
     add_ident(symtab[symtab_top_idx], name, attrs);
 }
 
-// Requires: !symtab_full()
-// Start a new scope (for a procedure)
+// Make sure that the stack has a slot for one more scope,
+// doubling its capacity when it is full.
+static void symtab_reserve()
+{
+    if ((unsigned int)(symtab_top_idx + 1) < symtab_capacity)
+    {
+        return;
+    }
+    unsigned int new_cap = (symtab == NULL) ? INITIAL_SYMTAB_CAPACITY
+                                            : 2 * symtab_capacity;
+    scope_t **new_symtab = (scope_t **)realloc(symtab, new_cap * sizeof(scope_t *));
+    if (new_symtab == NULL)
+    {
+        bail_with_error("No space for the symbol table's stack of scopes!");
+    }
+    for (unsigned int i = symtab_capacity; i < new_cap; i++)
+    {
+        new_symtab[i] = NULL;
+    }
+    symtab = new_symtab;
+    symtab_capacity = new_cap;
+}
+
+// Start a new scope (for a procedure),
+// reusing the storage of a scope that was left, if there is one
 void symtab_enter_scope()
 {
+    stats_count_scope();
+    symtab_reserve();
     symtab_top_idx++;
-    symtab[symtab_top_idx] = scope_create();
+    if (symtab[symtab_top_idx] == NULL)
+    {
+        symtab[symtab_top_idx] = scope_create();
+    }
 }
 
 // Requires: !symtab_empty()
+// End the current scope, freeing the attributes of its declarations
+// and keeping its (now empty) storage for the next symtab_enter_scope()
 void symtab_leave_scope()
 {
     if (symtab_top_idx < 0)
     {
         bail_with_error("Cannot leave scope, no scope on symtab's stack!");
     }
+    symtab_pop_bindings();
+    scope_clear(symtab[symtab_top_idx]);
     symtab_top_idx--;
 }
 
-// Return (a pointer to) the attributes of the given name
-// or NULL if there is no association for name in the symbol table.
-// (this looks back through all scopes).
-id_use *symtab_lookup(const char *name)
+// Return an id_use with the attributes of the given name
+// (and how many scopes out it was found),
+// or one whose attrs are NULL if there is no association for name
+// in the symbol table.
+// (this finds the innermost binding with one probe of the map of names).
+id_use symtab_lookup(const char *name)
 {
-    unsigned int levelsOut = 0;
-    for (int level = symtab_top_idx; 0 <= level; level--)
+    binding_t *b = symtab_innermost_binding(name);
+    if (b == NULL)
     {
-        id_attrs *attrs = scope_lookup(symtab[level], name);
-        if (attrs != NULL)
-        {
-            return id_use_create(attrs, levelsOut);
-        }
-        levelsOut++;
+        return id_use_create(NULL, 0);
     }
-    return NULL;
+    return id_use_create(b->attrs, symtab_top_idx - b->level);
 }
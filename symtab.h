@@ -4,9 +4,6 @@
 #include "scope.h"
 #include "id_use.h"
 
-// Maximum nesting of potential scopes
-#define MAX_NESTING 100
-
 // initialize the symbol table
 extern void symtab_initialize();
 
@@ -31,8 +28,13 @@ extern bool symtab_scope_full();
 extern unsigned int symtab_current_nesting_level();
 
 // Is the symbol table itself full?
+// (The symbol table grows as needed, so this is always false.)
 extern bool symtab_full();
 
+// All names passed to the symbol table must be interned
+// (i.e., returned by intern_string, see intern.h),
+// as the AST's names are.
+
 // Is name declared?
 // (this looks back through all scopes)
 extern bool symtab_declared(const char *name);
@@ -47,7 +49,6 @@ extern bool symtab_declared_in_current_scope(const char *name);
 // to the given attributes
 extern void symtab_insert(const char *name, id_attrs *attrs);
 
-// Requires: !symtab_full()
 // Start a new scope (for a block)
 extern void symtab_enter_scope();
 
@@ -55,8 +56,9 @@ extern void symtab_enter_scope();
 extern void symtab_leave_scope();
 
 // If name is declared, return
-// an id_use pointer for it, otherwise
-// return NULL if name isn't declared
-extern id_use *symtab_lookup(const char *name);
+// an id_use for it, otherwise
+// return an id_use whose attrs field is NULL
+// (the result is returned by value, so nothing is allocated)
+extern id_use symtab_lookup(const char *name);
 
 #endif
\ No newline at end of file
@@ -1,5 +1,6 @@
 /* $Id: unparser.c,v 1.22 2024/10/07 21:38:11 leavens Exp $ */
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
 #include "unparser.h"
 #include "utilities.h"
@@ -7,134 +8,245 @@
 // Amount of spaces to indent per nesting level
 #define SPACES_PER_LEVEL 2
 
+// Size of the output buffer; output is written to the FILE
+// in chunks of (at most) this many bytes
+#define OUT_BUF_SIZE 65536
+
+// Output not yet written, and the FILE it is destined for
+static char out_buf[OUT_BUF_SIZE];
+static size_t out_len = 0;
+static FILE *out_file = NULL;
+
+// Should each use of a name be followed by its lexical address?
+static bool show_addresses = false;
+
+// Write all buffered output to its FILE
+static void flush_out()
+{
+    if (out_len > 0 && fwrite(out_buf, 1, out_len, out_file) != out_len) {
+	bail_with_error("Error writing unparsed output!");
+    }
+    out_len = 0;
+}
+
+// Append the len bytes at s to the output destined for out
+static void write_bytes(FILE *out, const char *s, size_t len)
+{
+    if (out != out_file) {
+	flush_out();
+	out_file = out;
+    }
+    if (out_len + len > OUT_BUF_SIZE) {
+	flush_out();
+	if (len > OUT_BUF_SIZE) {
+	    if (fwrite(s, 1, len, out) != len) {
+		bail_with_error("Error writing unparsed output!");
+	    }
+	    return;
+	}
+    }
+    memcpy(out_buf + out_len, s, len);
+    out_len += len;
+}
+
+// Append the string s to the output destined for out
+static void write_str(FILE *out, const char *s)
+{
+    write_bytes(out, s, strlen(s));
+}
+
+// Append the decimal form of val to the output destined for out
+static void write_int(FILE *out, int val)
+{
+    char digits[12];
+    char *p = digits + sizeof(digits);
+    // work in unsigned so that INT_MIN can be negated
+    unsigned int mag = (val < 0) ? 0u - (unsigned int) val : (unsigned int) val;
+    do {
+	*--p = (char) ('0' + mag % 10);
+	mag /= 10;
+    } while (mag != 0);
+    if (val < 0) {
+	*--p = '-';
+    }
+    write_bytes(out, p, (size_t) (digits + sizeof(digits) - p));
+}
+
+// Append num spaces to the output destined for out
+static void write_spaces(FILE *out, int num)
+{
+    static const char spaces[] = "                                ";
+    while (num > 0) {
+	int n = (num < (int) sizeof(spaces) - 1) ? num : (int) sizeof(spaces) - 1;
+	write_bytes(out, spaces, (size_t) n);
+	num -= n;
+    }
+}
+
+// Write all output buffered for out to out
+void unparseFlush(FILE *out)
+{
+    if (out == out_file) {
+	flush_out();
+    }
+}
+
+// Make the unparse functions follow each use of a name
+// by its lexical address if show is true (see unparser.h)
+void unparseShowAddresses(bool show)
+{
+    show_addresses = show;
+}
+
+// Append name, which is used at the lexical address la,
+// to the output destined for out,
+// followed by la if show_addresses is true
+static void write_use(FILE *out, const char *name, lexical_address la)
+{
+    write_str(out, name);
+    if (show_addresses) {
+	if (lexical_address_is_resolved(la)) {
+	    write_str(out, "[");
+	    write_int(out, (int) la.levelsOutward);
+	    write_str(out, ",");
+	    write_int(out, (int) la.offset_count);
+	    write_str(out, "]");
+	} else {
+	    write_str(out, "[?]");
+	}
+    }
+}
+
 // Print SPACES_PER_LEVEL * level spaces to out
 static void indent(FILE *out, int level)
 {
-    int num = SPACES_PER_LEVEL * level;
-    for (int i = 0; i < num; i++) {
-	fprintf(out, " ");
-    }
+    write_spaces(out, SPACES_PER_LEVEL * level);
 }
 
 // Print (to out) a semicolon, but only if addSemiToEnd is true,
 // and then print a newline.
 static void newlineAndOptionalSemi(FILE *out, bool addSemiToEnd)
 {
-    fprintf(out, "%s\n", (addSemiToEnd ? ";" : ""));
+    write_str(out, addSemiToEnd ? ";\n" : "\n");
 }
 
 // Unparse the given program AST and then print a period and an newline
-void unparseProgram(FILE *out, block_t prog)
+void unparseProgram(FILE *out, const block_t *prog)
 {
     unparseBlock(out, prog, 0, false);
-    fprintf(out, ".\n");
+    write_str(out, ".\n");
+    unparseFlush(out);
 }
 
 // Unparse the given block, indented by the given level, to out
 // adding a semicolon to the end if addSemiToEnd is true.
-extern void unparseBlock(FILE *out, block_t blk, int level,
+extern void unparseBlock(FILE *out, const block_t *blk, int level,
 			 bool addSemiToEnd)
 {
     indent(out, level);
-    fprintf(out, "begin\n");
-    unparseConstDecls(out, blk.const_decls, level+1);
-    unparseVarDecls(out, blk.var_decls, level+1);
-    unparseProcDecls(out, blk.proc_decls, level+1);
-    unparseStmts(out, blk.stmts, level+1);
+    write_str(out, "begin\n");
+    unparseConstDecls(out, &blk->const_decls, level+1);
+    unparseVarDecls(out, &blk->var_decls, level+1);
+    unparseProcDecls(out, &blk->proc_decls, level+1);
+    unparseStmts(out, &blk->stmts, level+1);
     indent(out, level);
-    fprintf(out, "end");
+    write_str(out, "end");
     newlineAndOptionalSemi(out, addSemiToEnd);
 }
 
 // Unparse the list of const-decls given by the AST cds to out
 // with the given nesting level
 // (note that if cds == NULL, then nothing is printed)
-void unparseConstDecls(FILE *out, const_decls_t cds, int level)
+void unparseConstDecls(FILE *out, const const_decls_t *cds, int level)
 {
     // debug_print("unparseConstDecls entry ...\n");
-    assert(cds.type_tag == const_decls_ast);
-    const_decl_t *cd_listp = cds.start;
+    assert(cds->type_tag == const_decls_ast);
+    const const_decl_t *cd_listp = cds->start;
     while (cd_listp != NULL) {
-	unparseConstDecl(out, *cd_listp, level);
+	unparseConstDecl(out, cd_listp, level);
 	cd_listp = cd_listp->next;
     }
 }
 
 // Unparse a single const-def given by the AST cd to out,
 // indented for the given nesting level
-void unparseConstDecl(FILE *out, const_decl_t cd, int level)
+void unparseConstDecl(FILE *out, const const_decl_t *cd, int level)
 {
     // debug_print("unparseConstDecl entry ...\n");
     indent(out, level);
-    fprintf(out, "const ");
-    unparseConstDefList(out, cd.const_def_list, level);
+    write_str(out, "const ");
+    unparseConstDefList(out, &cd->const_def_list, level);
 }
 
 // Unparse the list of const-defs given by the AST cdl to out
 // with the given nesting level, followed by a semicolon and a newline.
-void unparseConstDefList(FILE *out, const_def_list_t cdl, int level)
+void unparseConstDefList(FILE *out, const const_def_list_t *cdl, int level)
 {
     // debug_print("unparseConstDefList entry ...\n");
-    assert(cdl.type_tag == const_def_list_ast);
+    assert(cdl->type_tag == const_def_list_ast);
     bool printed_already = false;
-    const_def_t *cdp = cdl.start;
+    const const_def_t *cdp = cdl->start;
     while (cdp != NULL) {
 	if (printed_already) {
-	    fprintf(out, ", ");
+	    write_str(out, ", ");
 	}
-	unparseConstDef(out, *cdp, level);
+	unparseConstDef(out, cdp, level);
 	printed_already = true;
 	cdp = cdp->next;
     }
-    fprintf(out, ";\n");
+    write_str(out, ";\n");
 }
 
 // Unparse the const-def given by the AST cdf to out
 // with the given nesting level
-extern void unparseConstDef(FILE *out, const_def_t cdf, int level)
+extern void unparseConstDef(FILE *out, const const_def_t *cdf, int level)
 {
-    fprintf(out, "%s = %d", cdf.ident.name, cdf.number.value);
+    write_str(out, cdf->ident.name);
+    write_str(out, " = ");
+    write_int(out, cdf->number.value);
 }
 
 // Unparse the list of vart-decls given by the AST vds to out
 // with the given nesting level
-// (note that if vds.var_decls == NULL, then nothing is printed)
-void unparseVarDecls(FILE *out, var_decls_t vds, int level)
+// (note that if vds->var_decls == NULL, then nothing is printed)
+void unparseVarDecls(FILE *out, const var_decls_t *vds, int level)
 {
     // debug_print("Entering unparseVarDecls ...\n");
-    assert(vds.type_tag == var_decls_ast);
-    var_decl_t *vdp = vds.var_decls;
+    assert(vds->type_tag == var_decls_ast);
+    const var_decl_t *vdp = vds->var_decls;
     while (vdp != NULL) {
-	unparseVarDecl(out, *vdp, level);
+	unparseVarDecl(out, vdp, level);
 	vdp = vdp->next;
     }
 }
 
 // Unparse a single var-decl given by the AST vd to out,
 // indented for the given nesting level
-void unparseVarDecl(FILE *out, var_decl_t vd, int level)
+void unparseVarDecl(FILE *out, const var_decl_t *vd, int level)
 {
     // debug_print("Entering unparseVarDecl ...\n");
     indent(out, level);
-    fprintf(out, "var");
-    unparseIdentList(out, vd.ident_list);
-    fprintf(out, ";\n");
+    write_str(out, "var");
+    unparseIdentList(out, &vd->ident_list);
+    write_str(out, ";\n");
 }
 
 // Unparse the identifiers in idents to out, with a space before each,
 // and a comma as a separator
-void unparseIdentList(FILE *out, ident_list_t ident_list)
+void unparseIdentList(FILE *out, const ident_list_t *ident_list)
 {
     // debug_print("Entering unparseIdentList ...\n");
-    ident_t *ip = ident_list.start;
+    const ident_t *ip = ident_list->start;
     bool already_printed =false;
     while (ip != NULL) {
 	// debug_print("in unparseIdents ip is %x\n", ip);
 	// debug_print("in unparseIdents ip->name is %s\n", ip->name);
 	if (already_printed) {
-	    fprintf(out, ", %s", ip->name);
+	    write_str(out, ", ");
+	    write_str(out, ip->name);
 	} else {
-	    fprintf(out, " %s", ip->name);
+	    write_str(out, " ");
+	    write_str(out, ip->name);
 	}
 	already_printed = true;
 	ip = ip->next;
@@ -143,53 +255,54 @@ void unparseIdentList(FILE *out, ident_list_t ident_list)
 
 // Unparse the list of proc-decls given by the AST pds to out
 // with the given nesting level
-// (note that if pds.proc_decls is NULL, then nothing is printed)
-void unparseProcDecls(FILE *out, proc_decls_t pds, int level)
+// (note that if pds->proc_decls is NULL, then nothing is printed)
+void unparseProcDecls(FILE *out, const proc_decls_t *pds, int level)
 {
     // debug_print("unparseProcDecls entry ...\n");
-    assert(pds.type_tag == proc_decls_ast);
-    proc_decl_t *pdp = pds.proc_decls;
+    assert(pds->type_tag == proc_decls_ast);
+    const proc_decl_t *pdp = pds->proc_decls;
     while (pdp != NULL) {
-	unparseProcDecl(out, *pdp, level);
+	unparseProcDecl(out, pdp, level);
 	pdp = pdp ->next;
     }
 }
 
 // Unparse the given proc-decl given by the AST pd to out
 // with the given nesting level followed by a semicolon
-void unparseProcDecl(FILE *out, proc_decl_t pd, int level)
+void unparseProcDecl(FILE *out, const proc_decl_t *pd, int level)
 {
     // debug_print("unparseProcDecl entry ...\n");
     indent(out, level);
-    fprintf(out, "proc %s\n", pd.name);
-    unparseBlock(out, *(pd.block), level, true);
+    write_str(out, "proc ");
+    write_str(out, pd->name);
+    write_str(out, "\n");
+    unparseBlock(out, pd->block, level, true);
 }
 
 
 // Unparse the stmts given by stmt to out
 // with indentation level given by level.
 // (The statements always occur before an end, so a semicolon is never added.)
-void unparseStmts(FILE *out, stmts_t stmts, int level)
+void unparseStmts(FILE *out, const stmts_t *stmts, int level)
 {
     // indent(out, level);
     // fprintf(out, "%% stmts at level %d\n", level);
-    if (stmts.stmts_kind != empty_stmts_e) {
-	stmt_list_t sl = stmts.stmt_list;
-	unparseStmtList(out, sl, level, false);
+    if (stmts->stmts_kind != empty_stmts_e) {
+	unparseStmtList(out, &stmts->stmt_list, level, false);
     }
 }
 
 // Unparse the stmts given by stmt to out
 // with indentation level given by level,
 // and add a semicolon at the end if addSemiToEnd is true.
-void unparseStmtList(FILE *out, stmt_list_t stmt_list, int level,
+void unparseStmtList(FILE *out, const stmt_list_t *stmt_list, int level,
 		     bool addSemiToEnd)
 {
     // indent(out, level);
     // fprintf(out, "%% stmtList at level %d\n", level);    
-    stmt_t *s = stmt_list.start;
+    const stmt_t *s = stmt_list->start;
     while (s != NULL) {
-	unparseStmt(out, *s, level, addSemiToEnd || (s->next != NULL));
+	unparseStmt(out, s, level, addSemiToEnd || (s->next != NULL));
 	s = s->next;
     }
 }
@@ -197,36 +310,36 @@ void unparseStmtList(FILE *out, stmt_list_t stmt_list, int level,
 // Unparse the statement given by the AST stmt to out,
 // indented for the given level,
 // adding a semicolon to the end if addSemiToENd is true.
-void unparseStmt(FILE *out, stmt_t stmt, int level, bool addSemiToEnd)
+void unparseStmt(FILE *out, const stmt_t *stmt, int level, bool addSemiToEnd)
 {
-    // debug_print("In unparseStmt stmt.type_tag is %d\n", stmt.type_tag);
-    assert(stmt.type_tag == stmt_ast);
-    switch (stmt.stmt_kind) {
+    // debug_print("In unparseStmt stmt->type_tag is %d\n", stmt->type_tag);
+    assert(stmt->type_tag == stmt_ast);
+    switch (stmt->stmt_kind) {
     case assign_stmt:
-	assert(stmt.data.assign_stmt.type_tag == assign_stmt_ast);
-	unparseAssignStmt(out, stmt.data.assign_stmt, level, addSemiToEnd);
+	assert(stmt->data.assign_stmt.type_tag == assign_stmt_ast);
+	unparseAssignStmt(out, &stmt->data.assign_stmt, level, addSemiToEnd);
 	break;
     case call_stmt:
-	unparseCallStmt(out, stmt.data.call_stmt, level, addSemiToEnd);
+	unparseCallStmt(out, &stmt->data.call_stmt, level, addSemiToEnd);
 	break;
     case if_stmt:
-	unparseIfStmt(out, stmt.data.if_stmt, level, addSemiToEnd);
+	unparseIfStmt(out, &stmt->data.if_stmt, level, addSemiToEnd);
 	break;
     case while_stmt:
-	unparseWhileStmt(out, stmt.data.while_stmt, level, addSemiToEnd);
+	unparseWhileStmt(out, &stmt->data.while_stmt, level, addSemiToEnd);
 	break;
     case read_stmt:
-	unparseReadStmt(out, stmt.data.read_stmt, level, addSemiToEnd);
+	unparseReadStmt(out, &stmt->data.read_stmt, level, addSemiToEnd);
 	break;
     case print_stmt:
-	unparsePrintStmt(out, stmt.data.print_stmt, level, addSemiToEnd);
+	unparsePrintStmt(out, &stmt->data.print_stmt, level, addSemiToEnd);
 	break;
     case block_stmt:
-	unparseBlockStmt(out, stmt.data.block_stmt, level, addSemiToEnd);
+	unparseBlockStmt(out, &stmt->data.block_stmt, level, addSemiToEnd);
 	break;
     default:
 	bail_with_error("Unknown stmt_kind (%d) in unparseStmt!",
-			stmt.stmt_kind);
+			stmt->stmt_kind);
 	break;
     }
 }
@@ -234,194 +347,403 @@ void unparseStmt(FILE *out, stmt_t stmt, int level, bool addSemiToEnd)
 // Unparse the assignment statment given by stmt to out
 // with indentation level given by level,
 // and add a semicolon at the end if addSemiToEnd is true.
-void unparseAssignStmt(FILE *out, assign_stmt_t stmt, int level,
+void unparseAssignStmt(FILE *out, const assign_stmt_t *stmt, int level,
 			      bool addSemiToEnd)
 {
     indent(out, level);
-    fprintf(out, "%s := ", stmt.name);
-    if (stmt.expr == NULL) {
+    write_use(out, stmt->name, stmt->lex_addr);
+    write_str(out, " := ");
+    if (stmt->expr == NULL) {
 	bail_with_error("Found null expression in assignment statment!");
     }
-    unparseExpr(out, *(stmt.expr));
+    unparseExpr(out, stmt->expr);
     newlineAndOptionalSemi(out, addSemiToEnd);
 }
 
 // Unparse the call statment given by stmt to out
 // with indentation level given by level,
 // and add a semicolon at the end if addSemiToEnd is true.
-void unparseCallStmt(FILE *out, call_stmt_t stmt, int level,
+void unparseCallStmt(FILE *out, const call_stmt_t *stmt, int level,
 			    bool addSemiToEnd)
 {
     indent(out, level);
-    fprintf(out, "call %s", stmt.name);
+    write_str(out, "call ");
+    write_use(out, stmt->name, stmt->lex_addr);
     newlineAndOptionalSemi(out, addSemiToEnd);
 }
 
 // Unparse the sequential statment given by stmt to out
 // with indentation level given by level (indenting the body one more level)
 // and add a semicolon at the end if addSemiToEnd is true.
-void unparseBlockStmt(FILE *out, block_stmt_t stmt, int level,
+void unparseBlockStmt(FILE *out, const block_stmt_t *stmt, int level,
 		      bool addSemiToEnd)
 {
-    unparseBlock(out, *(stmt.block), level, addSemiToEnd);
+    unparseBlock(out, stmt->block, level, addSemiToEnd);
 }
 
 // Unparse the if-statment given by stmt to out
 // with indentation level given by level (and each body indented one more),
 // and add a semicolon at the end if addSemiToEnd is true.
-void unparseIfStmt(FILE *out, if_stmt_t stmt, int level, bool addSemiToEnd)
+void unparseIfStmt(FILE *out, const if_stmt_t *stmt, int level,
+		   bool addSemiToEnd)
 {
     indent(out, level);
-    fprintf(out, "if ");
-    unparseCondition(out, stmt.condition);
-    fprintf(out, "\n");
+    write_str(out, "if ");
+    unparseCondition(out, &stmt->condition);
+    write_str(out, "\n");
     indent(out, level);
-    fprintf(out, "then\n");
-    unparseStmts(out, *(stmt.then_stmts), level+1);
-    if (stmt.else_stmts != NULL) {
+    write_str(out, "then\n");
+    unparseStmts(out, stmt->then_stmts, level+1);
+    if (stmt->else_stmts != NULL) {
 	indent(out, level);
-	fprintf(out, "else\n");
-	unparseStmts(out, *(stmt.else_stmts), level+1);
+	write_str(out, "else\n");
+	unparseStmts(out, stmt->else_stmts, level+1);
     }
     indent(out, level);
-    fprintf(out, "end");
+    write_str(out, "end");
     newlineAndOptionalSemi(out, addSemiToEnd);
 }
 
 // Unparse the while-statment given by stmt to out
 // with indentation level given by level (and the body indented one more),
 // and add a semicolon at the end if addSemiToEnd is true.
-void unparseWhileStmt(FILE *out, while_stmt_t stmt, int level,
+void unparseWhileStmt(FILE *out, const while_stmt_t *stmt, int level,
 		      bool addSemiToEnd)
 {
     indent(out, level);
-    fprintf(out, "while ");
-    unparseCondition(out, stmt.condition);
-    fprintf(out, "\n");
+    write_str(out, "while ");
+    unparseCondition(out, &stmt->condition);
+    write_str(out, "\n");
     indent(out, level);
-    fprintf(out, "do\n");
-    unparseStmts(out, *(stmt.body), level+1);
+    write_str(out, "do\n");
+    unparseStmts(out, stmt->body, level+1);
     indent(out, level);
-    fprintf(out, "end");
+    write_str(out, "end");
     newlineAndOptionalSemi(out, addSemiToEnd);
 }
 
 // Unparse the read statment given by stmt to out
 // and add a semicolon at the end if addSemiToEnd is true.
-void unparseReadStmt(FILE *out, read_stmt_t stmt, int level, bool addSemiToEnd)
+void unparseReadStmt(FILE *out, const read_stmt_t *stmt, int level,
+		     bool addSemiToEnd)
 {
     indent(out, level);
-    fprintf(out, "read %s", stmt.name);
+    write_str(out, "read ");
+    write_use(out, stmt->name, stmt->lex_addr);
     newlineAndOptionalSemi(out, addSemiToEnd);
 }
 
 // Unparse the write statment given by stmt to out
 // and add a semicolon at the end if addSemiToEnd is true.
-void unparsePrintStmt(FILE *out, print_stmt_t stmt, int level,
+void unparsePrintStmt(FILE *out, const print_stmt_t *stmt, int level,
 		      bool addSemiToEnd)
 {
     indent(out, level);
-    fprintf(out, "print ");
-    unparseExpr(out, stmt.expr);
+    write_str(out, "print ");
+    unparseExpr(out, &stmt->expr);
     newlineAndOptionalSemi(out, addSemiToEnd);
 }
 
 // Unparse the condition given by cond to out
-void unparseCondition(FILE *out, condition_t cond)
+void unparseCondition(FILE *out, const condition_t *cond)
 {
-    switch (cond.cond_kind) {
+    switch (cond->cond_kind) {
     case ck_db:
-	unparseDbCond(out, cond.data.db_cond);
+	unparseDbCond(out, &cond->data.db_cond);
 	break;
     case ck_rel:
-	unparseRelOpCond(out, cond.data.rel_op_cond);
+	unparseRelOpCond(out, &cond->data.rel_op_cond);
 	break;
     default:
 	bail_with_error("Unexpected condition_kind_e (%d) in unparseCondition!",
-			cond.cond_kind);
+			cond->cond_kind);
 	break;
     }
 }
 
 // Unparse the odd condition given by cond to out
-void unparseDbCond(FILE *out, db_condition_t dbcond)
+void unparseDbCond(FILE *out, const db_condition_t *dbcond)
 {
-    fprintf(out, "divisible ");
-    unparseExpr(out, dbcond.dividend);
-    fprintf(out, " by ");
-    unparseExpr(out, dbcond.divisor);
+    write_str(out, "divisible ");
+    unparseExpr(out, &dbcond->dividend);
+    write_str(out, " by ");
+    unparseExpr(out, &dbcond->divisor);
 }
 
 // Unparse the binary relation condition given by cond to out
-void unparseRelOpCond(FILE *out, rel_op_condition_t cond)
+void unparseRelOpCond(FILE *out, const rel_op_condition_t *cond)
 {
-    unparseExpr(out, cond.expr1);
-    fprintf(out, " ");
-    unparseToken(out, cond.rel_op);
-    fprintf(out, " ");
-    unparseExpr(out, cond.expr2);
+    unparseExpr(out, &cond->expr1);
+    write_str(out, " ");
+    unparseToken(out, &cond->rel_op);
+    write_str(out, " ");
+    unparseExpr(out, &cond->expr2);
 }
 
 // Unparse the given token, t, to out
-void unparseToken(FILE *out, token_t t)
+void unparseToken(FILE *out, const token_t *t)
 {
-    fprintf(out, "%s", t.text);
+    write_str(out, t->text);
 }
 
 // Unparse the expression given by the AST exp to out
 // adding parentheses to indicate the nesting relationships
-void unparseExpr(FILE *out, expr_t exp)
+void unparseExpr(FILE *out, const expr_t *exp)
 {
-    switch (exp.expr_kind) {
+    switch (exp->expr_kind) {
     case expr_bin:
-	unparseBinOpExpr(out, exp.data.binary);
+	unparseBinOpExpr(out, &exp->data.binary);
 	break;
     case expr_negated:
-	unparseNegatedExpr(out, exp.data.negated);
+	unparseNegatedExpr(out, &exp->data.negated);
 	break;
     case expr_ident:
-	unparseIdent(out, exp.data.ident);
+	unparseIdent(out, &exp->data.ident);
 	break;
     case expr_number:
-	unparseNumber(out, exp.data.number);
+	unparseNumber(out, &exp->data.number);
 	break;
     default:
 	bail_with_error("Unexpected expr_kind_e (%d) in unparseExpr!",
-			exp.expr_kind);
+			exp->expr_kind);
 	break;
     }
 }
 
 // Unparse the expression given by the AST exp to out
 // adding parentheses (whether needed or not)
-void unparseBinOpExpr(FILE *out, binary_op_expr_t exp)
+void unparseBinOpExpr(FILE *out, const binary_op_expr_t *exp)
 {
-    fprintf(out, "(");
-    unparseExpr(out, *(exp.expr1));
-    fprintf(out, " ");
-    unparseToken(out, exp.arith_op);
-    fprintf(out, " ");
-    unparseExpr(out, *(exp.expr2));
-    fprintf(out, ")");
+    write_str(out, "(");
+    unparseExpr(out, exp->expr1);
+    write_str(out, " ");
+    unparseToken(out, &exp->arith_op);
+    write_str(out, " ");
+    unparseExpr(out, exp->expr2);
+    write_str(out, ")");
 }
 
 // Unparse the expression given by the AST exp to out
 // adding parentheses (whether needed or not)
-void unparseNegatedExpr(FILE *out, negated_expr_t exp)
+void unparseNegatedExpr(FILE *out, const negated_expr_t *exp)
 {
-    fprintf(out, "-(");
-    unparseExpr(out, *(exp.expr));
-    fprintf(out, ")");
+    write_str(out, "-(");
+    unparseExpr(out, exp->expr);
+    write_str(out, ")");
 }
 
 // Unparse the given identifier reference (i.e., identifier use), id, to out
-void unparseIdent(FILE *out, ident_t id)
+void unparseIdent(FILE *out, const ident_t *id)
 {
-    fprintf(out, "%s", id.name);
+    write_use(out, id->name, id->lex_addr);
 }
 
 // Unparse the given number AST, num, to out in decimal format
-void unparseNumber(FILE *out, number_t num)
+void unparseNumber(FILE *out, const number_t *num)
+{
+    write_int(out, num->value);
+}
+
+// The rest of this file unparses a flat AST (see flat_ast.h),
+// with the same output as the functions above
+
+static void unparseFlatBlock(FILE *out, const flat_ast_t *fa, flat_index bi,
+			     int level, bool addSemiToEnd);
+static void unparseFlatStmts(FILE *out, const flat_ast_t *fa, flat_range sr,
+			     int level);
+
+// Unparse the expression with index ei in fa to out
+static void unparseFlatExpr(FILE *out, const flat_ast_t *fa, flat_index ei)
+{
+    const flat_expr_t *exp = &fa->exprs[ei];
+    switch (exp->expr_kind) {
+    case expr_bin:
+	write_str(out, "(");
+	unparseFlatExpr(out, fa, exp->data.binary.expr1);
+	write_str(out, " ");
+	write_str(out, exp->op);
+	write_str(out, " ");
+	unparseFlatExpr(out, fa, exp->data.binary.expr2);
+	write_str(out, ")");
+	break;
+    case expr_negated:
+	write_str(out, "-(");
+	unparseFlatExpr(out, fa, exp->data.negated);
+	write_str(out, ")");
+	break;
+    case expr_ident:
+	write_use(out, fa->idents[exp->data.ident].name,
+		  fa->idents[exp->data.ident].lex_addr);
+	break;
+    case expr_number:
+	write_int(out, exp->data.number);
+	break;
+    default:
+	bail_with_error("Unexpected expr_kind_e (%d) in unparseExpr!",
+			exp->expr_kind);
+	break;
+    }
+}
+
+// Unparse the condition with index ci in fa to out
+static void unparseFlatCondition(FILE *out, const flat_ast_t *fa,
+				 flat_index ci)
+{
+    const flat_condition_t *cond = &fa->conditions[ci];
+    switch (cond->cond_kind) {
+    case ck_db:
+	write_str(out, "divisible ");
+	unparseFlatExpr(out, fa, cond->expr1);
+	write_str(out, " by ");
+	unparseFlatExpr(out, fa, cond->expr2);
+	break;
+    case ck_rel:
+	unparseFlatExpr(out, fa, cond->expr1);
+	write_str(out, " ");
+	write_str(out, cond->rel_op);
+	write_str(out, " ");
+	unparseFlatExpr(out, fa, cond->expr2);
+	break;
+    default:
+	bail_with_error("Unexpected condition_kind_e (%d) in unparseCondition!",
+			cond->cond_kind);
+	break;
+    }
+}
+
+// Unparse the statement with index si in fa to out,
+// indented for the given level,
+// adding a semicolon to the end if addSemiToEnd is true.
+static void unparseFlatStmt(FILE *out, const flat_ast_t *fa, flat_index si,
+			    int level, bool addSemiToEnd)
+{
+    const flat_stmt_t *stmt = &fa->stmts[si];
+    switch (stmt->stmt_kind) {
+    case assign_stmt:
+	indent(out, level);
+	write_use(out, fa->idents[stmt->data.assign_stmt.ident].name,
+		  fa->idents[stmt->data.assign_stmt.ident].lex_addr);
+	write_str(out, " := ");
+	unparseFlatExpr(out, fa, stmt->data.assign_stmt.expr);
+	break;
+    case call_stmt:
+	indent(out, level);
+	write_str(out, "call ");
+	write_use(out, fa->idents[stmt->data.call_stmt].name,
+		  fa->idents[stmt->data.call_stmt].lex_addr);
+	break;
+    case if_stmt:
+	indent(out, level);
+	write_str(out, "if ");
+	unparseFlatCondition(out, fa, stmt->data.if_stmt.condition);
+	write_str(out, "\n");
+	indent(out, level);
+	write_str(out, "then\n");
+	unparseFlatStmts(out, fa, stmt->data.if_stmt.then_stmts, level+1);
+	if (stmt->data.if_stmt.has_else) {
+	    indent(out, level);
+	    write_str(out, "else\n");
+	    unparseFlatStmts(out, fa, stmt->data.if_stmt.else_stmts, level+1);
+	}
+	indent(out, level);
+	write_str(out, "end");
+	break;
+    case while_stmt:
+	indent(out, level);
+	write_str(out, "while ");
+	unparseFlatCondition(out, fa, stmt->data.while_stmt.condition);
+	write_str(out, "\n");
+	indent(out, level);
+	write_str(out, "do\n");
+	unparseFlatStmts(out, fa, stmt->data.while_stmt.body, level+1);
+	indent(out, level);
+	write_str(out, "end");
+	break;
+    case read_stmt:
+	indent(out, level);
+	write_str(out, "read ");
+	write_use(out, fa->idents[stmt->data.read_stmt].name,
+		  fa->idents[stmt->data.read_stmt].lex_addr);
+	break;
+    case print_stmt:
+	indent(out, level);
+	write_str(out, "print ");
+	unparseFlatExpr(out, fa, stmt->data.print_stmt);
+	break;
+    case block_stmt:
+	// the block prints its own end of line
+	unparseFlatBlock(out, fa, stmt->data.block_stmt, level, addSemiToEnd);
+	return;
+    default:
+	bail_with_error("Unknown stmt_kind (%d) in unparseStmt!",
+			stmt->stmt_kind);
+	break;
+    }
+    newlineAndOptionalSemi(out, addSemiToEnd);
+}
+
+// Unparse the statements in the range sr of fa's stmts to out,
+// indented for the given level, with semicolons between them
+static void unparseFlatStmts(FILE *out, const flat_ast_t *fa, flat_range sr,
+			     int level)
+{
+    for (uint32_t i = 0; i < sr.count; i++) {
+	unparseFlatStmt(out, fa, sr.first + i, level, i + 1 < sr.count);
+    }
+}
+
+// Unparse the block with index bi in fa, indented by the given level, to out
+// adding a semicolon to the end if addSemiToEnd is true.
+static void unparseFlatBlock(FILE *out, const flat_ast_t *fa, flat_index bi,
+			     int level, bool addSemiToEnd)
+{
+    const flat_block_t *blk = &fa->blocks[bi];
+    indent(out, level);
+    write_str(out, "begin\n");
+    for (uint32_t i = 0; i < blk->const_decls.count; i++) {
+	flat_range defs = fa->const_decls[blk->const_decls.first + i];
+	indent(out, level+1);
+	write_str(out, "const ");
+	for (uint32_t j = 0; j < defs.count; j++) {
+	    const flat_const_def_t *cdf = &fa->const_defs[defs.first + j];
+	    if (j > 0) {
+		write_str(out, ", ");
+	    }
+	    write_str(out, fa->idents[cdf->ident].name);
+	    write_str(out, " = ");
+	    write_int(out, cdf->value);
+	}
+	write_str(out, ";\n");
+    }
+    for (uint32_t i = 0; i < blk->var_decls.count; i++) {
+	flat_range ids = fa->var_decls[blk->var_decls.first + i];
+	indent(out, level+1);
+	write_str(out, "var");
+	for (uint32_t j = 0; j < ids.count; j++) {
+	    write_str(out, (j > 0) ? ", " : " ");
+	    write_str(out, fa->idents[ids.first + j].name);
+	}
+	write_str(out, ";\n");
+    }
+    for (uint32_t i = 0; i < blk->proc_decls.count; i++) {
+	const flat_proc_decl_t *pd = &fa->proc_decls[blk->proc_decls.first + i];
+	indent(out, level+1);
+	write_str(out, "proc ");
+	write_str(out, fa->idents[pd->ident].name);
+	write_str(out, "\n");
+	unparseFlatBlock(out, fa, pd->block, level+1, true);
+    }
+    unparseFlatStmts(out, fa, blk->stmts, level+1);
+    indent(out, level);
+    write_str(out, "end");
+    newlineAndOptionalSemi(out, addSemiToEnd);
+}
+
+// Unparse the program in the flat AST fa to out,
+// with the same output as unparseProgram
+void unparseFlatProgram(FILE *out, const flat_ast_t *fa)
 {
-    fprintf(out, "%d", num.value);
+    unparseFlatBlock(out, fa, fa->program, 0, false);
+    write_str(out, ".\n");
+    unparseFlush(out);
 }
@@ -43,6 +43,27 @@ static void vdebug_print(const char *fmt, va_list args)
 
 static void vbail_with_error(const char* fmt, va_list args);
 
+// where to go instead of exiting after an error (NULL means exit)
+static jmp_buf *error_recovery = NULL;
+
+// Make bail_with_error, bail_with_prog_error, and exit_with_error
+// longjmp to env (with a nonzero value) instead of exiting.
+// If env is NULL, then these functions exit the program again.
+void set_error_recovery(jmp_buf *env)
+{
+    error_recovery = env;
+}
+
+// If a recovery point has been set by set_error_recovery,
+// then longjmp to it, otherwise exit with the given code.
+void exit_with_error(int code)
+{
+    if (error_recovery != NULL) {
+	longjmp(*error_recovery, (code != 0) ? code : EXIT_FAILURE);
+    }
+    exit(code);
+}
+
 // Format a string error message and print it followed by a newline on stderr
 // using perror (for an OS error, if the errno is not 0)
 // then exit with a failure code, so a call to this does not return.
@@ -54,8 +75,9 @@ void bail_with_error(const char *fmt, ...)
     vbail_with_error(fmt, args);
 }
 
-// The variadic version of bail_with_error
-static void vbail_with_error(const char* fmt, va_list args)
+// Format a string error message and print it followed by a newline on stderr
+// using perror (for an OS error, if the errno is not 0)
+static void vprint_error(const char* fmt, va_list args)
 {
     extern int errno;
     char buff[2048];
@@ -66,7 +88,13 @@ static void vbail_with_error(const char* fmt, va_list args)
 	fprintf(stderr, "%s\n", buff);
     }
     fflush(stderr);
-    exit(EXIT_FAILURE);
+}
+
+// The variadic version of bail_with_error
+static void vbail_with_error(const char* fmt, va_list args)
+{
+    vprint_error(fmt, args);
+    exit_with_error(EXIT_FAILURE);
 }
 
 // Print an error message on stderr
@@ -78,13 +106,66 @@ void bail_with_prog_error(file_location floc, const char *fmt, ...)
 {
     fflush(stdout); // flush so output comes after what has happened already
     // print file, line, column information
-    fprintf(stderr, "%s: line %d ", floc.filename, floc.line);
+    fprintf(stderr, "%s: line %d ", file_location_filename(floc),
+	    file_location_line(floc));
 
     va_list(args);
     va_start(args, fmt);
     vbail_with_error(fmt, args);
 }
 
+// the most errors report_prog_error reports before stopping (0 = no limit)
+static unsigned int error_limit = 1;
+
+// the number of errors report_prog_error has reported
+static unsigned int prog_errors = 0;
+
+// Set the number of errors that report_prog_error reports
+// before it stops (0 means there is no limit)
+void set_error_limit(unsigned int limit)
+{
+    error_limit = limit;
+}
+
+// Return the limit set by set_error_limit (initially 1)
+unsigned int get_error_limit()
+{
+    return error_limit;
+}
+
+// Return the number of errors reported by report_prog_error
+// since the last call to reset_prog_errors
+unsigned int prog_error_count()
+{
+    return prog_errors;
+}
+
+// Forget the errors reported by report_prog_error (e.g., for a new file)
+void reset_prog_errors()
+{
+    prog_errors = 0;
+}
+
+// Print an error message on stderr, as for bail_with_prog_error.
+// If that makes the number of errors reach the limit
+// (see set_error_limit), then exit with a failure code,
+// otherwise return, so that checking can go on.
+void report_prog_error(file_location floc, const char *fmt, ...)
+{
+    fflush(stdout); // flush so output comes after what has happened already
+    fprintf(stderr, "%s: line %d ", file_location_filename(floc),
+	    file_location_line(floc));
+
+    va_list(args);
+    va_start(args, fmt);
+    prog_errors++;
+    if (error_limit != 0 && prog_errors >= error_limit) {
+	vbail_with_error(fmt, args);
+    }
+    vprint_error(fmt, args);
+    va_end(args);
+}
+
 #define BUF_SIZE 1024
 
 // Call yyerror to print an error message on stderr
@@ -3,6 +3,7 @@
 #define _UTILITIES_H
 #include <stdio.h>
 #include <stdbool.h>
+#include <setjmp.h>
 #include <assert.h>
 #include "file_location.h"
 
@@ -30,6 +31,37 @@ extern void bail_with_error(const char *fmt, ...);
 // Then exit with a failure code, so this function does not return.
 extern void bail_with_prog_error(file_location floc, const char *fmt, ...);
 
+// Make bail_with_error, bail_with_prog_error, and exit_with_error
+// longjmp to env (with a nonzero value) instead of exiting,
+// so that the caller can go on (e.g., to the next file).
+// If env is NULL, then these functions exit the program again.
+extern void set_error_recovery(jmp_buf *env);
+
+// If a recovery point has been set by set_error_recovery,
+// then longjmp to it, otherwise exit with the given code,
+// so a call to this does not return.
+extern void exit_with_error(int code);
+
+// Set the number of errors that report_prog_error reports
+// before it stops (0 means there is no limit)
+extern void set_error_limit(unsigned int limit);
+
+// Return the limit set by set_error_limit (initially 1)
+extern unsigned int get_error_limit();
+
+// Return the number of errors reported by report_prog_error
+// since the last call to reset_prog_errors
+extern unsigned int prog_error_count();
+
+// Forget the errors reported by report_prog_error (e.g., for a new file)
+extern void reset_prog_errors();
+
+// Print an error message on stderr, as for bail_with_prog_error.
+// If that makes the number of errors reach the limit
+// (see set_error_limit), then exit with a failure code,
+// otherwise return, so that checking can go on.
+extern void report_prog_error(file_location floc, const char *fmt, ...);
+
 // Call yyerror to print an error message on stderr
 // starting with the filename, ":", the lexer's current line number, ": ",
 // and then the formatted message (as in sprintf)